@@ -0,0 +1,609 @@
+/*
+ * Shared Intcode machine and engines, used by the Intcode tools.
+ *
+ * Every engine runs the same IntcodeMachine state and must behave exactly like
+ * the reference runOpcode (Intcode_Reference.h) on every well-formed
+ * instruction. Where the reference would crash, loop forever or read garbage,
+ * all engines instead stop with INTCODE_FAULT and leave the state untouched:
+ *
+ *   - pc at or past the end of memory halts, like the reference's while loop
+ *   - opcode (word % 100) outside 1-9 and 99, or a used parameter past the
+ *     end of memory, faults
+ *   - a used mode digit other than 0, 1 or 2 faults; a write parameter in
+ *     mode 1 is treated as mode 0, as the reference does
+ *   - an effective address outside [0, limit) faults; reading or writing past
+ *     the end of memory grows it to that address, reads included
+ *   - a jump target outside [0, INT_MAX] or a relative base outside int range
+ *     faults, since the reference keeps both in an int
+ *   - input with no pending input value stops with INTCODE_NEED_INPUT
+ *
+ * Engines share the signature IntcodeEngine and are listed in intcodeEngines,
+ * which the conformance and benchmark tools iterate over.
+ */
+
+#ifndef INTCODE_H
+#define INTCODE_H
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Intcode_Reference.h"
+
+enum IntcodeStatus {
+    INTCODE_RUNNING,
+    INTCODE_NEED_INPUT,
+    INTCODE_HALTED,
+    INTCODE_FAULT
+};
+
+// default bound on addresses, 16M words (128 MB) of memory
+const long intcodeDefaultLimit = 1L << 24;
+
+/*
+ * Engine scratch for the summarizing engine: a loop it failed to summarize is
+ * not analysed again for the next skip times it is taken
+ */
+struct IntcodeLoopHint {
+    uint32_t skip;
+    uint32_t failures;
+};
+
+/*
+ * Complete state of one Intcode machine. memory.size () is the logical size
+ * of memory, which matters: a jump past it halts the program.
+ */
+struct IntcodeMachine {
+    std::vector<long> memory;
+    long pc;
+    long relativeBase;
+    // input values, consumed from inputPos onward
+    std::vector<long> inputs;
+    size_t inputPos;
+    std::vector<long> outputs;
+    IntcodeStatus status;
+    const char *faultReason;
+    // instructions executed so far
+    long steps;
+    // addresses must stay below limit
+    long limit;
+    // address written by the last instruction, -1 if it wrote nothing
+    long lastWrite;
+    // engine scratch: decoded opcode words for the pre-decoded engine
+    std::vector<uint32_t> decoded;
+    // engine scratch: loop hints for the summarizing engine, by jump address
+    std::vector<IntcodeLoopHint> loopHints;
+};
+
+/*
+ * Runs at most maxSteps instructions, stopping early on halt, fault or missing
+ * input. Returns the number of instructions executed.
+ */
+typedef long (*IntcodeEngine) (IntcodeMachine &machine, long maxSteps);
+
+/*
+ * Reset the machine to the start of program with the given input values
+ */
+inline void initMachine (IntcodeMachine &machine,
+                         const std::vector<long> &program,
+                         const std::vector<long> &inputs,
+                         long limit = intcodeDefaultLimit) {
+    machine.memory = program;
+    machine.pc = 0;
+    machine.relativeBase = 0;
+    machine.inputs = inputs;
+    machine.inputPos = 0;
+    machine.outputs.clear ();
+    machine.status = INTCODE_RUNNING;
+    machine.faultReason = nullptr;
+    machine.steps = 0;
+    machine.limit = limit;
+    machine.lastWrite = -1;
+    machine.decoded.clear ();
+    machine.loopHints.clear ();
+}
+
+// helper function to count the parameters of an opcode, -1 if invalid
+inline int intcodeNumParams (long opcode) {
+    switch (opcode) {
+        case 1 : case 2 : case 7 : case 8 :
+            return 3;
+        case 5 : case 6 :
+            return 2;
+        case 3 : case 4 : case 9 :
+            return 1;
+        case 99 :
+            return 0;
+        default :
+            return -1;
+    }
+}
+
+// helper function to check whether parameter i (0-based) of opcode is written
+inline bool intcodeIsWrite (long opcode, int i) {
+    return ((opcode == 1 || opcode == 2 || opcode == 7 || opcode == 8) &&
+            i == 2) || (opcode == 3 && i == 0);
+}
+
+/*
+ * One instruction with its operands resolved and checked. Produced by
+ * decodeInstruction without changing the machine.
+ */
+struct IntcodeInstruction {
+    long opcode;
+    int numParams;
+    long params[3];
+    int modes[3];
+    // value of each read parameter, address of each memory parameter
+    long values[3];
+    long addresses[3];
+    // one past the highest address touched, memory grows to this
+    long reach;
+};
+
+/*
+ * Decode the instruction at pc and resolve its operands. Returns false and
+ * sets the fault reason if it would fault. Reads past the end of memory are
+ * resolved to 0 here; the caller grows memory to reach before executing.
+ */
+inline bool decodeInstruction (const IntcodeMachine &machine,
+                               IntcodeInstruction &instr,
+                               const char *&faultReason) {
+    long size = machine.memory.size ();
+    long word = machine.memory[machine.pc];
+    instr.opcode = word % 100;
+    instr.numParams = intcodeNumParams (instr.opcode);
+    if (instr.numParams < 0) {
+        faultReason = "invalid opcode";
+        return false;
+    }
+    if (machine.pc + instr.numParams >= size) {
+        faultReason = "parameter past end of memory";
+        return false;
+    }
+    instr.reach = 0;
+    long modeDigits = word / 100;
+    for (int i = 0; i < instr.numParams; i++) {
+        int mode = modeDigits % 10;
+        modeDigits /= 10;
+        long param = machine.memory[machine.pc + 1 + i];
+        bool write = intcodeIsWrite (instr.opcode, i);
+        instr.params[i] = param;
+        instr.modes[i] = mode;
+        instr.addresses[i] = -1;
+        if (mode < 0 || mode > 2) {
+            faultReason = "invalid parameter mode";
+            return false;
+        }
+        // immediate read: the value is the parameter itself
+        if (mode == 1 && !write) {
+            instr.values[i] = param;
+            continue;
+        }
+        long address = param;
+        if (mode == 2 && __builtin_add_overflow (param, machine.relativeBase,
+                                                 &address)) {
+            faultReason = "address out of range";
+            return false;
+        }
+        if (address < 0 || address >= machine.limit) {
+            faultReason = "address out of range";
+            return false;
+        }
+        instr.addresses[i] = address;
+        instr.values[i] = address < size ? machine.memory[address] : 0;
+        if (address + 1 > instr.reach) {
+            instr.reach = address + 1;
+        }
+    }
+    // control flow limits imposed by the reference's int registers
+    if ((instr.opcode == 5 && instr.values[0] != 0) ||
+        (instr.opcode == 6 && instr.values[0] == 0)) {
+        if (instr.values[1] < 0 || instr.values[1] > INT_MAX) {
+            faultReason = "jump target out of range";
+            return false;
+        }
+    }
+    if (instr.opcode == 9) {
+        long base = machine.relativeBase;
+        if (__builtin_add_overflow (base, instr.values[0], &base) ||
+            base < INT_MIN || base > INT_MAX) {
+            faultReason = "relative base out of range";
+            return false;
+        }
+    }
+    if (instr.opcode == 3 && machine.inputPos >= machine.inputs.size ()) {
+        faultReason = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// helper function to stop the machine on a fault or a missing input
+inline void stopMachine (IntcodeMachine &machine, const char *faultReason) {
+    if (faultReason == nullptr) {
+        machine.status = INTCODE_NEED_INPUT;
+    }
+    else {
+        machine.status = INTCODE_FAULT;
+        machine.faultReason = faultReason;
+    }
+}
+
+// helper function to resume a machine at the start of every run
+inline bool startRun (IntcodeMachine &machine) {
+    if (machine.status == INTCODE_HALTED || machine.status == INTCODE_FAULT) {
+        return false;
+    }
+    machine.status = INTCODE_RUNNING;
+    return true;
+}
+
+/*
+ * Reference engine: checks each instruction, then executes it with the
+ * verbatim reference runOpcode on the machine's memory
+ */
+inline long runReference (IntcodeMachine &machine, long maxSteps) {
+    if (!startRun (machine)) {
+        return 0;
+    }
+    long steps = 0;
+    while (steps < maxSteps) {
+        if (machine.pc >= (long)machine.memory.size ()) {
+            machine.status = INTCODE_HALTED;
+            break;
+        }
+        IntcodeInstruction instr;
+        const char *faultReason = nullptr;
+        if (!decodeInstruction (machine, instr, faultReason)) {
+            stopMachine (machine, faultReason);
+            break;
+        }
+        int index = machine.pc;
+        int relativeBase = machine.relativeBase;
+        long input = instr.opcode == 3 ? machine.inputs[machine.inputPos] : 0;
+        long output = 0;
+        int offset = reference::runOpcode (machine.memory, index, input, output,
+                                           relativeBase);
+        machine.lastWrite = -1;
+        for (int i = 0; i < instr.numParams; i++) {
+            if (intcodeIsWrite (instr.opcode, i)) {
+                machine.lastWrite = instr.addresses[i];
+            }
+        }
+        steps++;
+        // halt: the reference jumps past the end, keep pc on the 99 instead
+        if (instr.opcode == 99) {
+            machine.status = INTCODE_HALTED;
+            break;
+        }
+        machine.pc = (long)index + offset;
+        machine.relativeBase = relativeBase;
+        if (instr.opcode == 3) {
+            machine.inputPos++;
+        }
+        else if (instr.opcode == 4) {
+            machine.outputs.push_back (output);
+        }
+    }
+    machine.steps += steps;
+    return steps;
+}
+
+/*
+ * Opcode and modes of an instruction word as the interpreter caches them:
+ * opcode in the low 7 bits, three 2-bit modes above, then a valid bit. Returns
+ * 0 for a word that would fault.
+ */
+inline uint32_t packInstruction (long word) {
+    long opcode = word % 100;
+    long modeDigits = word / 100;
+    int numParams = intcodeNumParams (opcode);
+    if (numParams < 0) {
+        return 0;
+    }
+    uint32_t packed = opcode | (1u << 13);
+    for (int i = 0; i < numParams; i++) {
+        long mode = modeDigits % 10;
+        modeDigits /= 10;
+        if (mode < 0 || mode > 2) {
+            return 0;
+        }
+        // write parameters only distinguish relative mode
+        if (!intcodeIsWrite (opcode, i) || mode != 1) {
+            packed |= (uint32_t)mode << (7 + 2 * i);
+        }
+    }
+    return packed;
+}
+
+/*
+ * Skip whole iterations of the loop just closed by a backward jump, see
+ * Intcode_Summarize.h. Returns the number of instructions skipped.
+ */
+inline long summarizeLoop (IntcodeMachine &machine, long head, long jumpPc,
+                           long relativeBase, long maxSteps);
+
+/*
+ * Interpreter engine. Without Predecoded, every instruction word is split
+ * into opcode and modes as it is executed; with Predecoded, the split is
+ * cached per address in machine.decoded and dropped when the word is written.
+ * With Summarize, every taken backward jump is offered to summarizeLoop.
+ */
+template <bool Predecoded, bool Summarize = false>
+long runInterpreter (IntcodeMachine &machine, long maxSteps) {
+    if (!startRun (machine)) {
+        return 0;
+    }
+    std::vector<long> &memory = machine.memory;
+    std::vector<uint32_t> &decoded = machine.decoded;
+    long pc = machine.pc;
+    long relativeBase = machine.relativeBase;
+    long steps = 0;
+    if (Predecoded && decoded.size () != memory.size ()) {
+        decoded.resize (memory.size (), 0);
+    }
+    while (steps < maxSteps) {
+        long size = memory.size ();
+        if (pc >= size) {
+            machine.status = INTCODE_HALTED;
+            break;
+        }
+        uint32_t packed;
+        if (Predecoded && decoded[pc]) {
+            packed = decoded[pc];
+        }
+        else {
+            packed = packInstruction (memory[pc]);
+            if (!packed) {
+                // let the checked decoder name the fault
+                IntcodeInstruction instr;
+                const char *faultReason = nullptr;
+                machine.pc = pc;
+                machine.relativeBase = relativeBase;
+                decodeInstruction (machine, instr, faultReason);
+                stopMachine (machine, faultReason);
+                break;
+            }
+            if (Predecoded) {
+                decoded[pc] = packed;
+            }
+        }
+        int opcode = packed & 0x7F;
+        int numParams = intcodeNumParams (opcode);
+        if (pc + numParams >= size) {
+            machine.pc = pc;
+            machine.relativeBase = relativeBase;
+            stopMachine (machine, "parameter past end of memory");
+            break;
+        }
+
+        // resolve operands: address for memory modes, value for reads
+        long values[3];
+        long addresses[3];
+        long reach = 0;
+        const char *faultReason = nullptr;
+        for (int i = 0; i < numParams; i++) {
+            int mode = (packed >> (7 + 2 * i)) & 3;
+            long param = memory[pc + 1 + i];
+            if (mode == 1) {
+                values[i] = param;
+                continue;
+            }
+            long address = param;
+            if (mode == 2 && __builtin_add_overflow (param, relativeBase,
+                                                     &address)) {
+                address = -1;
+            }
+            if (address < 0 || address >= machine.limit) {
+                faultReason = "address out of range";
+                break;
+            }
+            addresses[i] = address;
+            values[i] = address < size ? memory[address] : 0;
+            reach = address + 1 > reach ? address + 1 : reach;
+        }
+        if (faultReason == nullptr) {
+            if ((opcode == 5 && values[0] != 0) ||
+                (opcode == 6 && values[0] == 0)) {
+                if (values[1] < 0 || values[1] > INT_MAX) {
+                    faultReason = "jump target out of range";
+                }
+            }
+            else if (opcode == 9) {
+                long base;
+                if (__builtin_add_overflow (relativeBase, values[0], &base) ||
+                    base < INT_MIN || base > INT_MAX) {
+                    faultReason = "relative base out of range";
+                }
+            }
+        }
+        if (faultReason != nullptr ||
+            (opcode == 3 && machine.inputPos >= machine.inputs.size ())) {
+            machine.pc = pc;
+            machine.relativeBase = relativeBase;
+            stopMachine (machine, faultReason);
+            break;
+        }
+        // grow memory to every address touched, reads included
+        if (reach > size) {
+            memory.resize (reach, 0);
+            if (Predecoded) {
+                decoded.resize (reach, 0);
+            }
+        }
+
+        long result;
+        bool write = false;
+        long instrPc = pc;
+        machine.lastWrite = -1;
+        switch (opcode) {
+            case 1 :
+                result = (long)((unsigned long)values[0] + values[1]);
+                write = true;
+                pc += 4;
+                break;
+            case 2 :
+                result = (long)((unsigned long)values[0] * values[1]);
+                write = true;
+                pc += 4;
+                break;
+            case 3 :
+                result = machine.inputs[machine.inputPos++];
+                write = true;
+                pc += 2;
+                break;
+            case 4 :
+                machine.outputs.push_back (values[0]);
+                pc += 2;
+                break;
+            case 5 :
+                pc = values[0] != 0 ? values[1] : pc + 3;
+                break;
+            case 6 :
+                pc = values[0] == 0 ? values[1] : pc + 3;
+                break;
+            case 7 :
+                result = values[0] < values[1];
+                write = true;
+                pc += 4;
+                break;
+            case 8 :
+                result = values[0] == values[1];
+                write = true;
+                pc += 4;
+                break;
+            case 9 :
+                relativeBase += values[0];
+                pc += 2;
+                break;
+            default :
+                // 99: halt, pc stays on the halt instruction
+                machine.status = INTCODE_HALTED;
+                break;
+        }
+        if (write) {
+            long address = addresses[numParams - 1];
+            memory[address] = result;
+            machine.lastWrite = address;
+            // self-modifying code: the cached split is stale
+            if (Predecoded) {
+                decoded[address] = 0;
+            }
+        }
+        steps++;
+        if (machine.status == INTCODE_HALTED) {
+            break;
+        }
+        if (Summarize && (opcode == 5 || opcode == 6) && pc <= instrPc) {
+            steps += summarizeLoop (machine, pc, instrPc, relativeBase,
+                                    maxSteps - steps);
+        }
+    }
+    machine.pc = pc;
+    machine.relativeBase = relativeBase;
+    machine.steps += steps;
+    return steps;
+}
+
+inline long runSwitch (IntcodeMachine &machine, long maxSteps) {
+    return runInterpreter<false> (machine, maxSteps);
+}
+
+inline long runDecoded (IntcodeMachine &machine, long maxSteps) {
+    return runInterpreter<true> (machine, maxSteps);
+}
+
+inline long runSummarized (IntcodeMachine &machine, long maxSteps) {
+    return runInterpreter<true, true> (machine, maxSteps);
+}
+
+/*
+ * Every engine, reference first
+ */
+struct IntcodeEngineInfo {
+    const char *name;
+    IntcodeEngine run;
+};
+
+const IntcodeEngineInfo intcodeEngines[] = {
+    {"reference", runReference},
+    {"switch", runSwitch},
+    {"decoded", runDecoded},
+    {"summarized", runSummarized},
+};
+
+const int intcodeNumEngines = sizeof (intcodeEngines) /
+                              sizeof (intcodeEngines[0]);
+
+/*
+ * Human readable form of the instruction at pc, e.g. "1201 add r5, #3 -> 7"
+ */
+inline std::string disassemble (const std::vector<long> &memory, long pc) {
+    if (pc < 0 || pc >= (long)memory.size ()) {
+        return "<past end of memory>";
+    }
+    const char *names[] = {"?", "add", "mul", "in", "out", "jnz", "jz", "lt",
+                           "eq", "arb"};
+    long word = memory[pc];
+    long opcode = word % 100;
+    int numParams = intcodeNumParams (opcode);
+    std::string text = std::to_string (word) + " ";
+    if (numParams < 0) {
+        return text + "<invalid opcode>";
+    }
+    text += opcode == 99 ? "halt" : names[opcode];
+    long modeDigits = word / 100;
+    for (int i = 0; i < numParams; i++) {
+        long mode = modeDigits % 10;
+        modeDigits /= 10;
+        text += i ? ", " : " ";
+        if (intcodeIsWrite (opcode, i)) {
+            text += "-> ";
+        }
+        if (pc + 1 + i >= (long)memory.size ()) {
+            text += "<missing>";
+            continue;
+        }
+        // '#' immediate, '@' relative, plain position
+        text += mode == 1 ? "#" : mode == 2 ? "@" : mode == 0 ? "" : "?";
+        text += std::to_string (memory[pc + 1 + i]);
+    }
+    return text;
+}
+
+/*
+ * Print the full machine state; memory is printed as runs of nonzero cells
+ */
+inline void dumpMachine (const IntcodeMachine &machine, const char *label,
+                         long maxCells = 256) {
+    const char *statusNames[] = {"running", "need input", "halted", "fault"};
+    printf ("[%s] status %s%s%s, pc %ld, relative base %ld, steps %ld\n",
+            label, statusNames[machine.status],
+            machine.faultReason ? ": " : "",
+            machine.faultReason ? machine.faultReason : "",
+            machine.pc, machine.relativeBase, machine.steps);
+    printf ("[%s] next: %s\n", label,
+            disassemble (machine.memory, machine.pc).c_str ());
+    printf ("[%s] inputs used %zu of %zu, outputs (%zu):", label,
+            machine.inputPos, machine.inputs.size (), machine.outputs.size ());
+    for (long value : machine.outputs) {
+        printf (" %ld", value);
+    }
+    printf ("\n[%s] memory size %zu, last write %ld:", label,
+            machine.memory.size (), machine.lastWrite);
+    long printed = 0;
+    for (size_t i = 0; i < machine.memory.size () && printed < maxCells; i++) {
+        if (machine.memory[i] != 0) {
+            printf (" [%zu]=%ld", i, machine.memory[i]);
+            printed++;
+        }
+    }
+    printf ("%s\n", printed == maxCells ? " ..." : "");
+}
+
+#include "Intcode_Summarize.h"
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Tiny Intcode assembler for building synthetic programs in C++.
+ *
+ * Operands are made with imm (immediate), pos (position), rel (relative) or,
+ * for addresses not known yet, with a label name plus an offset: immLabel is
+ * the label's address as an immediate, posLabel reads or writes the cell at
+ * the label. Labels are resolved when the program is finished, so forward
+ * references are fine. A variable declared with var is a labelled data cell
+ * at the current position, so variables go after the code.
+ *
+ * Example, counting down from the input:
+ *
+ *     IntcodeAsm a;
+ *     a.in (posLabel ("n"));
+ *     a.label ("loop");
+ *     a.out (posLabel ("n"));
+ *     a.add (posLabel ("n"), imm (-1), posLabel ("n"));
+ *     a.jnz (posLabel ("n"), immLabel ("loop"));
+ *     a.halt ();
+ *     a.var ("n");
+ *     std::vector<long> program = a.finish ();
+ */
+
+#ifndef INTCODE_ASM_H
+#define INTCODE_ASM_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * One instruction operand: mode 0 position, 1 immediate, 2 relative. If label
+ * is set, value is an offset added to the label's address.
+ */
+struct AsmArg {
+    int mode;
+    long value;
+    std::string label;
+};
+
+inline AsmArg imm (long value) {
+    return AsmArg {1, value, ""};
+}
+
+inline AsmArg pos (long address) {
+    return AsmArg {0, address, ""};
+}
+
+inline AsmArg rel (long offset) {
+    return AsmArg {2, offset, ""};
+}
+
+inline AsmArg immLabel (const std::string &label, long offset = 0) {
+    return AsmArg {1, offset, label};
+}
+
+inline AsmArg posLabel (const std::string &label, long offset = 0) {
+    return AsmArg {0, offset, label};
+}
+
+class IntcodeAsm {
+public:
+    void add (AsmArg a, AsmArg b, AsmArg dst) { emit (1, {a, b, dst}); }
+    void mul (AsmArg a, AsmArg b, AsmArg dst) { emit (2, {a, b, dst}); }
+    void in (AsmArg dst) { emit (3, {dst}); }
+    void out (AsmArg a) { emit (4, {a}); }
+    void jnz (AsmArg a, AsmArg target) { emit (5, {a, target}); }
+    void jz (AsmArg a, AsmArg target) { emit (6, {a, target}); }
+    void lt (AsmArg a, AsmArg b, AsmArg dst) { emit (7, {a, b, dst}); }
+    void eq (AsmArg a, AsmArg b, AsmArg dst) { emit (8, {a, b, dst}); }
+    void arb (AsmArg a) { emit (9, {a}); }
+    void halt () { emit (99, {}); }
+
+    // unconditional jump and copy, built from the instructions above
+    void jmp (AsmArg target) { jz (imm (0), target); }
+    void mov (AsmArg src, AsmArg dst) { add (src, imm (0), dst); }
+
+    // address of the next word to be emitted
+    long here () const {
+        return code.size ();
+    }
+
+    void label (const std::string &name) {
+        if (labels.count (name)) {
+            printf ("asm: label %s defined twice\n", name.c_str ());
+            exit (1);
+        }
+        labels[name] = code.size ();
+    }
+
+    // raw data word at the current position
+    void data (long value) {
+        code.push_back (value);
+    }
+
+    // labelled data cell at the current position, with an initial value
+    void var (const std::string &name, long init = 0) {
+        label (name);
+        data (init);
+    }
+
+    /*
+     * Resolve every label and return the program
+     */
+    std::vector<long> finish () {
+        for (std::pair<size_t, std::string> &fixup : fixups) {
+            std::map<std::string, long>::iterator found;
+            found = labels.find (fixup.second);
+            if (found == labels.end ()) {
+                printf ("asm: undefined label %s\n", fixup.second.c_str ());
+                exit (1);
+            }
+            code[fixup.first] += found->second;
+        }
+        fixups.clear ();
+        return code;
+    }
+
+private:
+    void emit (long opcode, std::vector<AsmArg> args) {
+        long word = opcode;
+        long scale = 100;
+        for (AsmArg &arg : args) {
+            word += arg.mode * scale;
+            scale *= 10;
+        }
+        code.push_back (word);
+        for (AsmArg &arg : args) {
+            if (!arg.label.empty ()) {
+                fixups.push_back ({code.size (), arg.label});
+            }
+            code.push_back (arg.value);
+        }
+    }
+
+    std::vector<long> code;
+    std::map<std::string, long> labels;
+    // code index to add the label's address to
+    std::vector<std::pair<size_t, std::string>> fixups;
+};
+
+#endif
@@ -0,0 +1,255 @@
+/*
+ * Compile-time Intcode interpreter.
+ *
+ * runConstexpr runs a program given as a constexpr array inside the compiler,
+ * so a day whose program and inputs are fixed at build time can have its
+ * answers computed during compilation and checked with static_assert. The
+ * days embed input.txt through a header generated by their makefile,
+ * input_program.h, defining inputProgram.
+ *
+ * The semantics are those of the shared engines (Intcode.h): the same
+ * opcodes, modes and relative base, pc past the end of memory halts, memory
+ * grows on access. Whatever the engines would fault on, and running out of
+ * inputs, steps or the fixed Capacity, ends the run with halted false; the
+ * caller then falls back to running the program at runtime.
+ *
+ * A constant expression that overflows or runs past the compiler's limits is
+ * a compile error rather than a failed run, so the interpreter never lets
+ * that happen: arithmetic that would overflow a long also ends the run, and
+ * the step bound keeps every run well inside GCC's default operation count
+ * (each step costs a few hundred operations). Callers that chain several runs
+ * into one constant must share a step budget between them.
+ *
+ * The known programs from the puzzle texts are checked with static_assert at
+ * the end of this header, so every day that includes it re-verifies the
+ * interpreter when it is compiled.
+ */
+
+#ifndef INTCODE_CONSTEXPR_H
+#define INTCODE_CONSTEXPR_H
+
+#include <cstddef>
+#include <initializer_list>
+
+const int constexprMaxOutputs = 16;
+// default bound on instructions, well inside the compiler's evaluation limits
+const long constexprDefaultSteps = 1L << 14;
+// longest program the compiler may copy; longer ones are left to runtime,
+// below the compiler's limit on loop iterations
+const size_t constexprMaxWords = 1 << 16;
+
+/*
+ * Cell set before the program starts, like Day 2's noun and verb
+ */
+struct ConstexprPatch {
+    long address;
+    long value;
+};
+
+/*
+ * Final state of a compile-time run
+ */
+template <size_t Capacity>
+struct ConstexprRun {
+    long memory[Capacity];
+    long size;
+    long outputs[constexprMaxOutputs];
+    int numOutputs;
+    long steps;
+    // true only if the program halted normally
+    bool halted;
+};
+
+// helper function to count the parameters of an opcode, -1 if invalid
+constexpr int constexprNumParams (long opcode) {
+    return opcode == 1 || opcode == 2 || opcode == 7 || opcode == 8 ? 3 :
+           opcode == 5 || opcode == 6 ? 2 :
+           opcode == 3 || opcode == 4 || opcode == 9 ? 1 :
+           opcode == 99 ? 0 : -1;
+}
+
+/*
+ * Run program with the patched cells and inputs for at most maxSteps
+ * instructions, entirely at compile time when used in a constant expression
+ */
+template <size_t Capacity, size_t N>
+constexpr ConstexprRun<Capacity> runConstexpr (
+        const long (&program)[N], std::initializer_list<ConstexprPatch> patches,
+        std::initializer_list<long> inputs,
+        long maxSteps = constexprDefaultSteps) {
+    ConstexprRun<Capacity> run {};
+    if (N > Capacity || N > constexprMaxWords) {
+        return run;
+    }
+    for (size_t i = 0; i < N; i++) {
+        run.memory[i] = program[i];
+    }
+    run.size = N;
+    for (const ConstexprPatch &patch : patches) {
+        if (patch.address < 0 || patch.address >= (long)Capacity) {
+            return run;
+        }
+        run.memory[patch.address] = patch.value;
+        if (patch.address >= run.size) {
+            run.size = patch.address + 1;
+        }
+    }
+
+    const long *nextInput = inputs.begin ();
+    long pc = 0;
+    long relativeBase = 0;
+    while (run.steps < maxSteps) {
+        if (pc >= run.size) {
+            run.halted = true;
+            return run;
+        }
+        long word = run.memory[pc];
+        long opcode = word % 100;
+        int numParams = constexprNumParams (opcode);
+        if (numParams < 0 || pc + numParams >= run.size) {
+            return run;
+        }
+        // resolve each parameter to a value and, for memory modes, an address
+        long values[3] = {0, 0, 0};
+        long addresses[3] = {0, 0, 0};
+        long modeDigits = word / 100;
+        for (int i = 0; i < numParams; i++) {
+            long mode = modeDigits % 10;
+            modeDigits /= 10;
+            long param = run.memory[pc + 1 + i];
+            bool write = i == 2 || opcode == 3;
+            if (mode == 1 && !write) {
+                values[i] = param;
+                continue;
+            }
+            if (mode < 0 || mode > 2) {
+                return run;
+            }
+            long address = param;
+            if ((mode == 2 &&
+                 __builtin_add_overflow (param, relativeBase, &address)) ||
+                address < 0 || address >= (long)Capacity) {
+                return run;
+            }
+            if (address >= run.size) {
+                run.size = address + 1;
+            }
+            addresses[i] = address;
+            values[i] = run.memory[address];
+        }
+
+        run.steps++;
+        long result = 0;
+        switch (opcode) {
+            case 1 :
+                if (__builtin_add_overflow (values[0], values[1], &result)) {
+                    return run;
+                }
+                run.memory[addresses[2]] = result;
+                pc += 4;
+                break;
+            case 2 :
+                if (__builtin_mul_overflow (values[0], values[1], &result)) {
+                    return run;
+                }
+                run.memory[addresses[2]] = result;
+                pc += 4;
+                break;
+            case 3 :
+                if (nextInput == inputs.end ()) {
+                    return run;
+                }
+                run.memory[addresses[0]] = *nextInput++;
+                pc += 2;
+                break;
+            case 4 :
+                if (run.numOutputs == constexprMaxOutputs) {
+                    return run;
+                }
+                run.outputs[run.numOutputs++] = values[0];
+                pc += 2;
+                break;
+            case 5 :
+                pc = values[0] != 0 ? values[1] : pc + 3;
+                break;
+            case 6 :
+                pc = values[0] == 0 ? values[1] : pc + 3;
+                break;
+            case 7 :
+                run.memory[addresses[2]] = values[0] < values[1];
+                pc += 4;
+                break;
+            case 8 :
+                run.memory[addresses[2]] = values[0] == values[1];
+                pc += 4;
+                break;
+            case 9 :
+                if (__builtin_add_overflow (relativeBase, values[0],
+                                            &relativeBase)) {
+                    return run;
+                }
+                pc += 2;
+                break;
+            default :
+                run.halted = true;
+                return run;
+        }
+        if (pc < 0) {
+            return run;
+        }
+    }
+    return run;
+}
+
+/* Programs from the puzzle texts, checked whenever this header is compiled - */
+
+namespace constexpr_checks {
+
+constexpr long day2Example[] = {1, 9, 10, 3, 2, 3, 11, 0, 99, 30, 40, 50};
+static_assert (runConstexpr<16> (day2Example, {}, {}).memory[0] == 3500,
+               "Day 2 example");
+
+// outputs 999, 1000 or 1001 as the input is below, equal to or above 8
+constexpr long day5Compare[] = {
+    3, 21, 1008, 21, 8, 20, 1005, 20, 22, 107, 8, 21, 20, 1006, 20, 31, 1106,
+    0, 36, 98, 0, 0, 1002, 21, 125, 20, 4, 20, 1105, 1, 46, 104, 999, 1105, 1,
+    46, 1101, 1000, 1, 20, 4, 20, 1105, 1, 46, 98, 99};
+static_assert (runConstexpr<64> (day5Compare, {}, {7}).outputs[0] == 999,
+               "Day 5 compare, below 8");
+static_assert (runConstexpr<64> (day5Compare, {}, {8}).outputs[0] == 1000,
+               "Day 5 compare, equal to 8");
+static_assert (runConstexpr<64> (day5Compare, {}, {9}).outputs[0] == 1001,
+               "Day 5 compare, above 8");
+
+// relative base: outputs a copy of itself
+constexpr long day9Quine[] = {109, 1, 204, -1, 1001, 100, 1, 100, 1008, 100,
+                              16, 101, 1006, 101, 0, 99};
+constexpr bool matchesQuine () {
+    ConstexprRun<128> run = runConstexpr<128> (day9Quine, {}, {});
+    if (!run.halted || run.numOutputs != 16) {
+        return false;
+    }
+    for (int i = 0; i < 16; i++) {
+        if (run.outputs[i] != day9Quine[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert (matchesQuine (), "Day 9 quine");
+
+constexpr long day9Large[] = {104, 1125899906842624, 99};
+static_assert (runConstexpr<4> (day9Large, {}, {}).outputs[0] ==
+               1125899906842624, "Day 9 large output");
+
+// runs that would not compile unless they stop on their own
+constexpr long overflowing[] = {1102, 4611686018427387904, 4, 0, 99};
+static_assert (!runConstexpr<8> (overflowing, {}, {}).halted,
+               "overflow ends the run");
+constexpr long endless[] = {1105, 1, 0};
+static_assert (runConstexpr<4> (endless, {}, {}).steps ==
+               constexprDefaultSteps, "step bound ends the run");
+
+} // namespace constexpr_checks
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ * Corpus of heavy synthetic Intcode programs for measuring engines.
+ *
+ * The puzzle inputs finish in microseconds, so these programs are built with
+ * the assembler to run millions of instructions each, covering the patterns
+ * engines have to get right and fast:
+ *
+ *   sieve    prime sieve, array cells addressed by patching its own operands
+ *   sort     insertion sort of a reversed array, indexed by relative base
+ *   fib      naive recursive Fibonacci on a relative-base call stack
+ *   selfmod  loop that rewrites its own opcode word on every iteration
+ *   far      strided writes and reads over memory far past the program
+ *   triangle nested counted loops summing by repeated addition
+ *
+ * Each program takes a single input sized from a scale factor and has a
+ * C++ model of its single output, so a broken engine or program is caught.
+ */
+
+#ifndef INTCODE_CORPUS_H
+#define INTCODE_CORPUS_H
+
+#include <vector>
+
+#include "Intcode_Asm.h"
+
+struct CorpusProgram {
+    const char *name;
+    std::vector<long> (*build) ();
+    // input for a scale factor, 1 being a few million instructions
+    long (*inputFor) (int scale);
+    // expected single output for an input
+    long (*expected) (long input);
+};
+
+/* Prime sieve: count primes below the input ------------------------------- */
+
+inline std::vector<long> buildSieve () {
+    IntcodeAsm a;
+    a.in (posLabel ("n"));
+    a.mov (imm (2), posLabel ("i"));
+    a.label ("loopI");
+    a.lt (posLabel ("i"), posLabel ("n"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("done"));
+    // read mark[i] by patching the address operand of the next instruction
+    a.add (posLabel ("i"), immLabel ("sieve"), posLabel ("readMark", 1));
+    a.label ("readMark");
+    a.add (pos (0), imm (0), posLabel ("marked"));
+    a.jnz (posLabel ("marked"), immLabel ("nextI"));
+    a.add (posLabel ("count"), imm (1), posLabel ("count"));
+    a.mul (posLabel ("i"), posLabel ("i"), posLabel ("j"));
+    a.label ("loopJ");
+    a.lt (posLabel ("j"), posLabel ("n"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("nextI"));
+    // mark[j] = 1, again by patching the destination operand
+    a.add (posLabel ("j"), immLabel ("sieve"), posLabel ("writeMark", 3));
+    a.label ("writeMark");
+    a.add (imm (1), imm (0), pos (0));
+    a.add (posLabel ("j"), posLabel ("i"), posLabel ("j"));
+    a.jmp (immLabel ("loopJ"));
+    a.label ("nextI");
+    a.add (posLabel ("i"), imm (1), posLabel ("i"));
+    a.jmp (immLabel ("loopI"));
+    a.label ("done");
+    a.out (posLabel ("count"));
+    a.halt ();
+    a.var ("n");
+    a.var ("i");
+    a.var ("j");
+    a.var ("t");
+    a.var ("marked");
+    a.var ("count");
+    // the sieve array starts right after the variables and grows on demand
+    a.label ("sieve");
+    return a.finish ();
+}
+
+inline long sieveInput (int scale) {
+    return 200000L * scale;
+}
+
+inline long sieveExpected (long n) {
+    std::vector<bool> composite (n > 2 ? n : 2, false);
+    long count = 0;
+    for (long i = 2; i < n; i++) {
+        if (!composite[i]) {
+            count++;
+            for (long j = i * i; j < n; j += i) {
+                composite[j] = true;
+            }
+        }
+    }
+    return count;
+}
+
+/* Insertion sort: sort n, n-1, ..., 1 and output sum of a[k] * (k + 1) ---- */
+
+inline std::vector<long> buildSort () {
+    IntcodeAsm a;
+    a.in (posLabel ("n"));
+    // relative base tracks a[p]; p is kept in a variable
+    a.arb (immLabel ("array"));
+    a.label ("fill");
+    a.lt (posLabel ("p"), posLabel ("n"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("sortStart"));
+    a.mul (posLabel ("p"), imm (-1), posLabel ("t"));
+    a.add (posLabel ("t"), posLabel ("n"), rel (0));
+    a.arb (imm (1));
+    a.add (posLabel ("p"), imm (1), posLabel ("p"));
+    a.jmp (immLabel ("fill"));
+
+    a.label ("sortStart");
+    a.mov (imm (1), posLabel ("i"));
+    a.label ("outer");
+    a.lt (posLabel ("i"), posLabel ("n"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("sumStart"));
+    // move the relative base from a[p] to a[i]
+    a.mul (posLabel ("p"), imm (-1), posLabel ("t"));
+    a.add (posLabel ("t"), posLabel ("i"), posLabel ("t"));
+    a.arb (posLabel ("t"));
+    a.mov (posLabel ("i"), posLabel ("p"));
+    a.mov (rel (0), posLabel ("key"));
+    a.arb (imm (-1));
+    a.add (posLabel ("p"), imm (-1), posLabel ("p"));
+    a.label ("inner");
+    // shift a[p] up while p >= 0 and a[p] > key
+    a.lt (posLabel ("p"), imm (0), posLabel ("t"));
+    a.jnz (posLabel ("t"), immLabel ("place"));
+    a.lt (posLabel ("key"), rel (0), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("place"));
+    a.mov (rel (0), rel (1));
+    a.arb (imm (-1));
+    a.add (posLabel ("p"), imm (-1), posLabel ("p"));
+    a.jmp (immLabel ("inner"));
+    a.label ("place");
+    a.mov (posLabel ("key"), rel (1));
+    a.add (posLabel ("i"), imm (1), posLabel ("i"));
+    a.jmp (immLabel ("outer"));
+
+    // checksum from a[0] up, moving the relative base back to a[0] first
+    a.label ("sumStart");
+    a.mul (posLabel ("p"), imm (-1), posLabel ("t"));
+    a.arb (posLabel ("t"));
+    a.mov (imm (0), posLabel ("p"));
+    a.label ("sum");
+    a.lt (posLabel ("p"), posLabel ("n"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("done"));
+    a.add (posLabel ("p"), imm (1), posLabel ("t"));
+    a.mul (posLabel ("t"), rel (0), posLabel ("t"));
+    a.add (posLabel ("t"), posLabel ("total"), posLabel ("total"));
+    a.arb (imm (1));
+    a.add (posLabel ("p"), imm (1), posLabel ("p"));
+    a.jmp (immLabel ("sum"));
+    a.label ("done");
+    a.out (posLabel ("total"));
+    a.halt ();
+    a.var ("n");
+    a.var ("p");
+    a.var ("i");
+    a.var ("t");
+    a.var ("key");
+    a.var ("total");
+    a.label ("array");
+    return a.finish ();
+}
+
+inline long sortInput (int scale) {
+    // quadratic: scale the length by the square root of the scale
+    long n = 700;
+    for (int s = 1; s * 4 <= scale; s *= 4) {
+        n *= 2;
+    }
+    return n;
+}
+
+inline long sortExpected (long n) {
+    return n * (n + 1) * (2 * n + 1) / 6;
+}
+
+/* Recursive Fibonacci: frame @0 return address, @1 argument, @2 result ---- */
+
+inline std::vector<long> buildFib () {
+    IntcodeAsm a;
+    a.in (posLabel ("n"));
+    a.arb (immLabel ("stack"));
+    a.mov (posLabel ("n"), rel (1));
+    a.mov (immLabel ("main"), rel (0));
+    a.jmp (immLabel ("fib"));
+    a.label ("main");
+    a.out (rel (2));
+    a.halt ();
+
+    a.label ("fib");
+    a.lt (rel (1), imm (2), rel (3));
+    a.jz (rel (3), immLabel ("recurse"));
+    a.mov (rel (1), rel (2));
+    a.jmp (rel (0));
+    a.label ("recurse");
+    // fib (n - 1) in a new frame four cells up
+    a.add (rel (1), imm (-1), rel (5));
+    a.mov (immLabel ("back1"), rel (4));
+    a.arb (imm (4));
+    a.jmp (immLabel ("fib"));
+    a.label ("back1");
+    a.arb (imm (-4));
+    a.mov (rel (6), rel (3));
+    // fib (n - 2), keeping fib (n - 1) in @3
+    a.add (rel (1), imm (-2), rel (5));
+    a.mov (immLabel ("back2"), rel (4));
+    a.arb (imm (4));
+    a.jmp (immLabel ("fib"));
+    a.label ("back2");
+    a.arb (imm (-4));
+    a.add (rel (3), rel (6), rel (2));
+    a.jmp (rel (0));
+    a.var ("n");
+    a.label ("stack");
+    return a.finish ();
+}
+
+inline long fibInput (int scale) {
+    // exponential: every two steps of n is roughly 2.6x the work
+    long n = 24;
+    for (int s = 2; s <= scale; s *= 2) {
+        n++;
+    }
+    return n;
+}
+
+inline long fibExpected (long n) {
+    long prev = 0;
+    long curr = 1;
+    for (long i = 0; i < n; i++) {
+        long next = prev + curr;
+        prev = curr;
+        curr = next;
+    }
+    return prev;
+}
+
+/* Self-modifying loop: flip between add and mul on every iteration -------- */
+
+inline std::vector<long> buildSelfMod () {
+    IntcodeAsm a;
+    a.in (posLabel ("k"));
+    a.label ("loop");
+    a.jz (posLabel ("k"), immLabel ("done"));
+    // opcode word 1001 (add) <-> 1002 (mul): word = 2003 - word
+    a.mul (posLabel ("op"), imm (-1), posLabel ("op"));
+    a.add (posLabel ("op"), imm (2003), posLabel ("op"));
+    a.label ("op");
+    a.add (posLabel ("acc"), imm (1), posLabel ("acc"));
+    a.add (posLabel ("k"), imm (-1), posLabel ("k"));
+    a.jmp (immLabel ("loop"));
+    a.label ("done");
+    a.out (posLabel ("acc"));
+    a.halt ();
+    a.var ("k");
+    a.var ("acc");
+    return a.finish ();
+}
+
+inline long selfModInput (int scale) {
+    return 1000000L * scale;
+}
+
+inline long selfModExpected (long k) {
+    // the first iteration runs as mul, then add, mul, ...
+    return k / 2;
+}
+
+/* Far memory: strided writes then reads, four million cells past the code - */
+
+const long farBase = 1L << 22;
+const long farStride = 7;
+
+inline std::vector<long> buildFar () {
+    IntcodeAsm a;
+    a.in (posLabel ("m"));
+    a.label ("fill");
+    a.lt (posLabel ("k"), posLabel ("m"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("sum"));
+    a.mul (posLabel ("k"), imm (farStride), posLabel ("t"));
+    a.add (posLabel ("t"), imm (farBase), posLabel ("write", 3));
+    a.label ("write");
+    a.mov (posLabel ("k"), pos (0));
+    a.add (posLabel ("k"), imm (1), posLabel ("k"));
+    a.jmp (immLabel ("fill"));
+    a.label ("sum");
+    a.jz (posLabel ("k"), immLabel ("done"));
+    a.add (posLabel ("k"), imm (-1), posLabel ("k"));
+    a.mul (posLabel ("k"), imm (farStride), posLabel ("t"));
+    a.add (posLabel ("t"), imm (farBase), posLabel ("read", 1));
+    a.label ("read");
+    a.add (pos (0), posLabel ("total"), posLabel ("total"));
+    a.jmp (immLabel ("sum"));
+    a.label ("done");
+    a.out (posLabel ("total"));
+    a.halt ();
+    a.var ("m");
+    a.var ("k");
+    a.var ("t");
+    a.var ("total");
+    return a.finish ();
+}
+
+inline long farInput (int scale) {
+    // stay below the default 16M word address limit
+    long m = 250000L * scale;
+    long maxM = ((1L << 24) - farBase) / farStride - 1;
+    return m < maxM ? m : maxM;
+}
+
+inline long farExpected (long m) {
+    return m * (m - 1) / 2;
+}
+
+/* Nested counted loops: sum of j for 0 <= j < i < n ------------------------ */
+
+inline std::vector<long> buildTriangle () {
+    IntcodeAsm a;
+    a.in (posLabel ("n"));
+    a.label ("outer");
+    a.lt (posLabel ("i"), posLabel ("n"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("done"));
+    a.mov (imm (0), posLabel ("j"));
+    a.label ("inner");
+    a.lt (posLabel ("j"), posLabel ("i"), posLabel ("t"));
+    a.jz (posLabel ("t"), immLabel ("next"));
+    a.add (posLabel ("total"), posLabel ("j"), posLabel ("total"));
+    a.add (posLabel ("j"), imm (1), posLabel ("j"));
+    a.jmp (immLabel ("inner"));
+    a.label ("next");
+    a.add (posLabel ("i"), imm (1), posLabel ("i"));
+    a.jmp (immLabel ("outer"));
+    a.label ("done");
+    a.out (posLabel ("total"));
+    a.halt ();
+    a.var ("n");
+    a.var ("i");
+    a.var ("j");
+    a.var ("t");
+    a.var ("total");
+    return a.finish ();
+}
+
+inline long triangleInput (int scale) {
+    // quadratic like sort
+    long n = 1200;
+    for (int s = 1; s * 4 <= scale; s *= 4) {
+        n *= 2;
+    }
+    return n;
+}
+
+inline long triangleExpected (long n) {
+    return n * (n - 1) * (n - 2) / 6;
+}
+
+const CorpusProgram intcodeCorpus[] = {
+    {"sieve", buildSieve, sieveInput, sieveExpected},
+    {"sort", buildSort, sortInput, sortExpected},
+    {"fib", buildFib, fibInput, fibExpected},
+    {"selfmod", buildSelfMod, selfModInput, selfModExpected},
+    {"far", buildFar, farInput, farExpected},
+    {"triangle", buildTriangle, triangleInput, triangleExpected},
+};
+
+const int intcodeCorpusSize = sizeof (intcodeCorpus) /
+                              sizeof (intcodeCorpus[0]);
+
+#endif
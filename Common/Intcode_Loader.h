@@ -0,0 +1,189 @@
+/*
+ * Fast loader for comma separated Intcode programs, shared by every Intcode
+ * day and tool.
+ *
+ * The text file is memory mapped and parsed in place with std::from_chars, so
+ * no string is allocated per number. Commas are counted first with memchr
+ * (vectorized in libc) to reserve the word array in one allocation.
+ *
+ * Optionally, a sidecar binary image "<path>.icache" is written next to the
+ * text, holding the parsed words and keyed by a hash of the text contents.
+ * Later runs hash the mapped text, map the sidecar and copy the ready-made
+ * word array, skipping the parse. A stale or damaged sidecar is ignored and
+ * rewritten. The sidecar is enabled by passing useCache, which defaults to
+ * whether the INTCODE_CACHE environment variable is set to something other
+ * than "0".
+ */
+
+#ifndef INTCODE_LOADER_H
+#define INTCODE_LOADER_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "Mapped_File.h"
+
+/*
+ * Header of the sidecar binary image, followed by count 64-bit words
+ */
+struct IntcodeCacheHeader {
+    char magic[8];
+    uint64_t textHash;
+    uint64_t textSize;
+    uint64_t count;
+};
+
+const char intcodeCacheMagic[8] = {'I', 'N', 'T', 'C', 'O', 'D', 'E', '1'};
+
+// helper function to check the INTCODE_CACHE environment switch
+inline bool intcodeCacheEnabled () {
+    const char *flag = getenv ("INTCODE_CACHE");
+    return flag != nullptr && *flag && strcmp (flag, "0") != 0;
+}
+
+/*
+ * 64-bit hash of the program text, consuming 8 bytes per step
+ */
+inline uint64_t hashText (const char *text, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        memcpy (&chunk, text + i, 8);
+        hash = (hash ^ chunk) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 0x100000001B3ull;
+    }
+    hash ^= hash >> 29;
+    return hash * 0xC4CEB9FE1A85EC53ull;
+}
+
+/*
+ * Parse comma separated words in place. Whitespace around numbers is skipped.
+ * Returns false at the first token that is not a number.
+ */
+template <typename Word>
+bool parseProgram (const char *text, size_t size, std::vector<Word> &words) {
+    // count the delimiters up front to allocate the words once
+    size_t numCommas = 0;
+    const char *scan = text;
+    const char *end = text + size;
+    while ((scan = (const char *)memchr (scan, ',', end - scan)) != nullptr) {
+        numCommas++;
+        scan++;
+    }
+    words.reserve (words.size () + numCommas + 1);
+
+    const char *pos = text;
+    while (pos < end) {
+        // skip the separators between numbers
+        while (pos < end && (*pos == ',' || *pos == ' ' || *pos == '\n' ||
+                             *pos == '\r' || *pos == '\t')) {
+            pos++;
+        }
+        if (pos == end) {
+            break;
+        }
+        Word value;
+        std::from_chars_result result = std::from_chars (pos, end, value);
+        if (result.ec != std::errc ()) {
+            return false;
+        }
+        words.push_back (value);
+        pos = result.ptr;
+    }
+    return true;
+}
+
+// helper function to read the words from a sidecar matching the text hash
+template <typename Word>
+bool readProgramCache (const std::string &cachePath, uint64_t textHash,
+                       uint64_t textSize, std::vector<Word> &words) {
+    MappedFile cache (cachePath.c_str ());
+    if (cache.size < sizeof (IntcodeCacheHeader)) {
+        return false;
+    }
+    IntcodeCacheHeader header;
+    memcpy (&header, cache.data, sizeof (header));
+    if (memcmp (header.magic, intcodeCacheMagic, 8) != 0 ||
+        header.textHash != textHash || header.textSize != textSize ||
+        cache.size != sizeof (header) + header.count * sizeof (int64_t)) {
+        return false;
+    }
+    const int64_t *image = (const int64_t *)(cache.data + sizeof (header));
+    // a sidecar written for wider words may hold values this Word cannot
+    for (uint64_t i = 0; i < header.count; i++) {
+        if (image[i] < std::numeric_limits<Word>::min () ||
+            image[i] > std::numeric_limits<Word>::max ()) {
+            return false;
+        }
+    }
+    words.assign (image, image + header.count);
+    return true;
+}
+
+// helper function to write the sidecar atomically: temp file, then rename
+template <typename Word>
+void writeProgramCache (const std::string &cachePath, uint64_t textHash,
+                        uint64_t textSize, const std::vector<Word> &words) {
+    IntcodeCacheHeader header;
+    memcpy (header.magic, intcodeCacheMagic, 8);
+    header.textHash = textHash;
+    header.textSize = textSize;
+    header.count = words.size ();
+    std::vector<int64_t> image (words.begin (), words.end ());
+
+    std::string tempPath = cachePath + ".tmp" + std::to_string (getpid ());
+    FILE *out = fopen (tempPath.c_str (), "wb");
+    if (out == nullptr) {
+        return;
+    }
+    bool ok = fwrite (&header, sizeof (header), 1, out) == 1 &&
+              fwrite (image.data (), sizeof (int64_t), image.size (), out) ==
+              image.size ();
+    ok = fclose (out) == 0 && ok;
+    // a failed cache write only costs the parse again on the next run
+    if (!ok || rename (tempPath.c_str (), cachePath.c_str ()) != 0) {
+        remove (tempPath.c_str ());
+    }
+}
+
+/*
+ * Load the program at path into words, replacing their contents. Returns
+ * false if the file cannot be read or does not parse.
+ */
+template <typename Word>
+bool loadProgram (const char *path, std::vector<Word> &words,
+                  bool useCache = intcodeCacheEnabled ()) {
+    words.clear ();
+    MappedFile text (path);
+    if (text.data == nullptr) {
+        return false;
+    }
+    if (!useCache) {
+        return parseProgram (text.data, text.size, words);
+    }
+
+    std::string cachePath = std::string (path) + ".icache";
+    uint64_t textHash = hashText (text.data, text.size);
+    if (readProgramCache (cachePath, textHash, text.size, words)) {
+        return true;
+    }
+    words.clear ();
+    if (!parseProgram (text.data, text.size, words)) {
+        return false;
+    }
+    writeProgramCache (cachePath, textHash, text.size, words);
+    return true;
+}
+
+#endif
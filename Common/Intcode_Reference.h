@@ -0,0 +1,203 @@
+/*
+ * Reference Intcode engine: the parseOpcode/accessInput/getVal/writeVal and
+ * runOpcode functions exactly as they appear in the Day 9 engine, as patched
+ * in Days 11 and 13 to grow memory on writes. Kept verbatim (inside their own
+ * namespace) as the ground truth that every faster engine is checked against.
+ *
+ * These functions assume a well-formed instruction; the checks that turn a
+ * malformed one into a fault live in runReference (Intcode.h).
+ */
+
+#ifndef INTCODE_REFERENCE_H
+#define INTCODE_REFERENCE_H
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+namespace reference {
+
+inline void parseOpcode (long &opcode, int &mode1, int &mode2, int &mode3) {
+    // last two digits contain opcode
+    long opcodeFinal = opcode % 100;
+    opcode = opcode / 100;
+    // next least significant digit is mode of param 0, then 1, and so on
+    // leading zeros parsed as zeros, as intended as per specifications
+    mode1 = opcode % 10;
+    opcode = opcode / 10;
+    mode2 = opcode % 10;
+    opcode = opcode / 10;
+    mode3 = opcode % 10;
+    opcode = opcode / 10;
+    // update initial param to first parsed opcode
+    opcode = opcodeFinal;
+}
+
+inline long accessInput (std::vector<long> &inputVals, int index) {
+    // bounds checking: index cannot be negative
+    if (index < 0) {
+        printf ("accessing out of bounds %d\n", index);
+        return -99999;
+    }
+    // higher than given input, resize and return 0
+    else if ((size_t)index >= inputVals.size ()) {
+        inputVals.resize (index + 1);
+        return 0;
+    }
+    // within bounds
+    else {
+        return inputVals.at (index);
+    }
+}
+
+// helper function to return the actual value for a parameter access
+inline long getVal (std::vector<long> &inputVals, long param, int mode,
+             int &relativeBase) {
+    // immediate mode
+    if (mode == 1) {
+        return param;
+    }
+    // position mode and relative mode
+    else if (mode == 0 || mode == 2) {
+        // calculate index to access, mode 0 absolute position
+        int indexAccess = !mode ? param : param + relativeBase;
+        return accessInput (inputVals, indexAccess);
+    }
+
+    // invalid mode
+    else {
+        printf ("invalid input encountered\n");
+        return -99999;
+    }
+}
+
+// helper function to write the val at the index, which can be above bounds
+inline void writeVal (std::vector<long> &inputVals, long toWrite, int index) {
+    if ((size_t)index >= inputVals.size ()) {
+        inputVals.resize (index + 1);
+    }
+    inputVals.at (index) = toWrite;
+}
+
+inline int runOpcode (std::vector<long> &inputVals, int &index, long input,
+               long &output, int &relativeBase) {
+    // offset program counter, varies from how many inputs used for op
+    int offset = 0;
+    // get raw opcode from input
+    long opcode = inputVals.at (index);
+    // obtain param modes and final opcode from parse helper
+    int mode1, mode2, mode3, writeIndex;
+    parseOpcode (opcode, mode1, mode2, mode3);
+    // assume fetch max of 3 immediate params to simplify following switch cases
+    long param [3];
+    for (int i = 0; (size_t)(i + index + 1) < inputVals.size() && i < 3; i++) {
+        param[i] = inputVals.at (i + index + 1);
+    }
+    // must access final 3 values based on the utilized params for each case
+    long val1, val2;
+//    printf ("running opcode %d at %d\n", opcode, index);
+    switch (opcode) {
+        // opcode 99: halt, return size to break out of caller loop
+        case 99 :
+            offset = inputVals.size ();
+            break;
+        // opcode 1 and 2 both valid opcodes from Day 2
+        case 1 :
+        case 2 :
+            // determine write index if in relative mode
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            val2 = getVal (inputVals, param[1], mode2, relativeBase);
+            writeIndex = mode3 == 2 ? param[2] + relativeBase : param[2];
+            // opcode 1: add vals; otherwise opcode 2: multiply final vals
+            if (opcode == 1) {
+                writeVal (inputVals, val1 + val2, writeIndex);
+            }
+            else {
+                writeVal (inputVals, val1 * val2, writeIndex);
+            }
+            offset = 4;
+            break;
+        // part 1, opcode 3: write to position given by immediate param
+        case 3 :
+            // determine write index if in relative mode
+            writeIndex = mode1 == 2 ? param[0] + relativeBase : param[0];
+            writeVal (inputVals, input, writeIndex) ;
+            offset = 2;
+            break;
+        // part 1, opcode 4: "output" from single param and mode
+        case 4 :
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            output = val1;
+            offset = 2;
+            break;
+        // part 2, opcode 5: if first param nonzero, set pc using second param
+        case 5 :
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            val2 = getVal (inputVals, param[1], mode2, relativeBase);
+            // check final value of first param, update pc accordingly
+            if (val1 != 0) {
+                index = val2;
+            }
+            else {
+                offset = 3;
+            }
+            break;
+        // part 2, opcode 6: if first param zero, set pc using second param
+        case 6 :
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            val2 = getVal (inputVals, param[1], mode2, relativeBase);
+            // check final value of first param, update pc accordingly
+            if (val1 == 0) {
+                index = val2;
+            }
+            else {
+                offset = 3;
+            }
+            break;
+        // part 2, opcode 7: if first param < second param, 1 in third param
+        case 7 :
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            val2 = getVal (inputVals, param[1], mode2, relativeBase);
+            // determine write index if in relative mode
+            writeIndex = mode3 == 2 ? param[2] + relativeBase : param[2];
+            // compare final values of first and second params
+            if (val1 < val2) {
+                writeVal (inputVals, 1, writeIndex);
+            }
+            else {
+                writeVal (inputVals, 0, writeIndex);
+            }
+            offset = 4;
+            break;
+        // part 2, opcode 8: if first param == second param, 1 in third param
+        case 8 :
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            val2 = getVal (inputVals, param[1], mode2, relativeBase);
+            // determine write index if in relative mode
+            writeIndex = mode3 == 2 ? param[2] + relativeBase : param[2];
+            // compare final values of first and second params
+            if (val1 == val2) {
+                writeVal (inputVals, 1, writeIndex);
+            }
+            else {
+                writeVal (inputVals, 0, writeIndex);
+            }
+            offset = 4;
+            break;
+        // Day 9: adjusts the relative base from value of only parameter
+        case 9 :
+            val1 = getVal (inputVals, param[0], mode1, relativeBase);
+            relativeBase += val1;
+            offset = 2;
+            break;
+        default :
+            printf ("invalid opcode, error in input\n");
+            break;
+    }
+    // return program counter to determine next index of opcode for caller
+    return offset;
+}
+
+}
+
+#endif
@@ -0,0 +1,291 @@
+/*
+ * Persistent cache of Intcode run results, shared between processes.
+ *
+ * A run is identified by its program image, the cells patched before it
+ * starts (Day 2's noun and verb) and its input sequence. resultKey hashes
+ * those into a ResultKey, taking the program as a hash from hashProgram so
+ * it is hashed once for many runs. The cache maps the key to the run's
+ * outputs and its final cell 0, so a repeated run is answered without
+ * executing anything.
+ *
+ * The cache is a fixed-size hash table in a memory mapped file: a header page
+ * and then slots grouped in buckets of resultBucketSlots. A key lives in the
+ * bucket its hash selects; a full bucket evicts its least recently used slot,
+ * so the file never grows. Results with more than resultMaxOutputs outputs are
+ * not cached.
+ *
+ * Readers take no lock. Every slot carries a sequence number that a writer
+ * makes odd while it rewrites the slot and even again afterwards; a reader
+ * that sees an odd or changed sequence treats the slot as a miss. Writers
+ * serialize with flock on the file, which orders writes between processes.
+ * Threads of one process should each open their own handle when writing.
+ *
+ * The days enable the cache with the INTCODE_RESULTS environment variable,
+ * set to the path of the cache file.
+ */
+
+#ifndef INTCODE_RESULTS_H
+#define INTCODE_RESULTS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Intcode_Loader.h"
+
+const int resultMaxOutputs = 11;
+const long resultBucketSlots = 8;
+// default capacity: 64K slots, 8 MB on disk
+const long resultDefaultSlots = 1L << 16;
+
+const char resultCacheMagic[8] = {'I', 'C', 'R', 'E', 'S', 'U', 'L', '1'};
+
+/*
+ * Header page of the cache file
+ */
+struct ResultHeader {
+    char magic[8];
+    uint64_t numSlots;
+    // use counter, bumped on every hit and store for LRU eviction
+    uint64_t clock;
+};
+
+/*
+ * One cached result, 128 bytes. An empty slot has keyCheck 0.
+ */
+struct ResultSlot {
+    // odd while a writer is rewriting the slot
+    uint32_t sequence;
+    uint32_t numOutputs;
+    uint64_t lastUse;
+    uint64_t keyHash;
+    uint64_t keyCheck;
+    int64_t cell0;
+    int64_t outputs[resultMaxOutputs];
+};
+
+struct ResultKey {
+    uint64_t hash;
+    uint64_t check;
+};
+
+/*
+ * Open cache file mapped for reading and writing
+ */
+struct ResultCache {
+    int fd;
+    size_t size;
+    ResultHeader *header;
+    ResultSlot *slots;
+    long numSlots;
+};
+
+const size_t resultHeaderSize = 4096;
+
+/*
+ * Hash of a program image, whatever its word type
+ */
+template <typename Word>
+uint64_t hashProgram (const std::vector<Word> &program) {
+    std::vector<long> words (program.begin (), program.end ());
+    return hashText ((const char *)words.data (),
+                     words.size () * sizeof (long));
+}
+
+/*
+ * Hash a run: program, then patched (address, value) cells, then inputs
+ */
+inline ResultKey resultKey (uint64_t programHash,
+                            const std::vector<std::pair<long, long>> &patches,
+                            const std::vector<long> &inputs) {
+    std::vector<uint64_t> summary;
+    summary.push_back (programHash);
+    summary.push_back (patches.size ());
+    for (const std::pair<long, long> &patch : patches) {
+        summary.push_back (patch.first);
+        summary.push_back (patch.second);
+    }
+    summary.push_back (inputs.size ());
+    summary.insert (summary.end (), inputs.begin (), inputs.end ());
+    ResultKey key;
+    key.hash = hashText ((const char *)summary.data (),
+                         summary.size () * sizeof (uint64_t));
+    // second, independent hash to tell colliding keys apart
+    summary.push_back (0x5bd1e995);
+    key.check = hashText ((const char *)summary.data (),
+                          summary.size () * sizeof (uint64_t)) | 1;
+    return key;
+}
+
+/*
+ * Open or create the cache file. A file of another layout is not touched;
+ * the open fails instead.
+ */
+inline bool openResultCache (ResultCache &cache, const char *path,
+                             long numSlots = resultDefaultSlots) {
+    cache.fd = -1;
+    cache.header = nullptr;
+    cache.slots = nullptr;
+    numSlots = (numSlots + resultBucketSlots - 1) / resultBucketSlots *
+               resultBucketSlots;
+    int fd = open (path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    // initialize a new file under the writer lock
+    flock (fd, LOCK_EX);
+    struct stat info;
+    bool ok = fstat (fd, &info) == 0;
+    if (ok && info.st_size == 0) {
+        ResultHeader header {};
+        memcpy (header.magic, resultCacheMagic, 8);
+        header.numSlots = numSlots;
+        ok = ftruncate (fd, resultHeaderSize +
+                        numSlots * sizeof (ResultSlot)) == 0 &&
+             pwrite (fd, &header, sizeof (header), 0) ==
+             (ssize_t)sizeof (header);
+        info.st_size = resultHeaderSize + numSlots * sizeof (ResultSlot);
+    }
+    flock (fd, LOCK_UN);
+    void *addr = MAP_FAILED;
+    if (ok && info.st_size > (off_t)resultHeaderSize) {
+        addr = mmap (nullptr, info.st_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    }
+    if (addr == MAP_FAILED) {
+        close (fd);
+        return false;
+    }
+    ResultHeader *header = (ResultHeader *)addr;
+    long fileSlots = (info.st_size - resultHeaderSize) / sizeof (ResultSlot);
+    if (memcmp (header->magic, resultCacheMagic, 8) != 0 ||
+        (long)header->numSlots != fileSlots || fileSlots == 0 ||
+        fileSlots % resultBucketSlots != 0) {
+        munmap (addr, info.st_size);
+        close (fd);
+        return false;
+    }
+    cache.fd = fd;
+    cache.size = info.st_size;
+    cache.header = header;
+    cache.slots = (ResultSlot *)((char *)addr + resultHeaderSize);
+    cache.numSlots = fileSlots;
+    return true;
+}
+
+/*
+ * Open the cache named by INTCODE_RESULTS, if it is set
+ */
+inline bool openResultCacheFromEnv (ResultCache &cache) {
+    const char *path = getenv ("INTCODE_RESULTS");
+    if (path == nullptr || !*path) {
+        cache.fd = -1;
+        return false;
+    }
+    return openResultCache (cache, path);
+}
+
+inline void closeResultCache (ResultCache &cache) {
+    if (cache.fd >= 0) {
+        munmap (cache.header, cache.size);
+        close (cache.fd);
+        cache.fd = -1;
+    }
+}
+
+// helper function to find the first slot of a key's bucket
+inline ResultSlot *resultBucket (ResultCache &cache, const ResultKey &key) {
+    long numBuckets = cache.numSlots / resultBucketSlots;
+    return cache.slots + (key.hash % numBuckets) * resultBucketSlots;
+}
+
+/*
+ * Look a run up. On a hit, fills outputs and cell0 and returns true.
+ */
+inline bool lookupResult (ResultCache &cache, const ResultKey &key,
+                          std::vector<long> &outputs, long &cell0) {
+    if (cache.fd < 0) {
+        return false;
+    }
+    ResultSlot *bucket = resultBucket (cache, key);
+    for (long s = 0; s < resultBucketSlots; s++) {
+        ResultSlot &slot = bucket[s];
+        uint32_t before = __atomic_load_n (&slot.sequence, __ATOMIC_ACQUIRE);
+        if ((before & 1) ||
+            __atomic_load_n (&slot.keyCheck, __ATOMIC_RELAXED) != key.check ||
+            __atomic_load_n (&slot.keyHash, __ATOMIC_RELAXED) != key.hash) {
+            continue;
+        }
+        uint32_t numOutputs = __atomic_load_n (&slot.numOutputs,
+                                               __ATOMIC_RELAXED);
+        if (numOutputs > (uint32_t)resultMaxOutputs) {
+            continue;
+        }
+        outputs.resize (numOutputs);
+        for (uint32_t i = 0; i < numOutputs; i++) {
+            outputs[i] = __atomic_load_n (&slot.outputs[i], __ATOMIC_RELAXED);
+        }
+        cell0 = __atomic_load_n (&slot.cell0, __ATOMIC_RELAXED);
+        // the slot must not have been rewritten while it was copied
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        if (__atomic_load_n (&slot.sequence, __ATOMIC_RELAXED) != before) {
+            return false;
+        }
+        uint64_t now = __atomic_add_fetch (&cache.header->clock, 1,
+                                           __ATOMIC_RELAXED);
+        __atomic_store_n (&slot.lastUse, now, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Store the result of a run, replacing the bucket's least recently used slot
+ * if the key is new. Returns false if the result is too long to cache.
+ */
+inline bool storeResult (ResultCache &cache, const ResultKey &key,
+                         const std::vector<long> &outputs, long cell0) {
+    if (cache.fd < 0 || outputs.size () > (size_t)resultMaxOutputs) {
+        return false;
+    }
+    flock (cache.fd, LOCK_EX);
+    ResultSlot *bucket = resultBucket (cache, key);
+    ResultSlot *victim = bucket;
+    for (long s = 0; s < resultBucketSlots; s++) {
+        ResultSlot &slot = bucket[s];
+        if (slot.keyCheck == key.check && slot.keyHash == key.hash) {
+            victim = &slot;
+            break;
+        }
+        if (slot.keyCheck == 0 ||
+            (victim->keyCheck != 0 && slot.lastUse < victim->lastUse)) {
+            victim = &slot;
+        }
+    }
+    uint64_t now = __atomic_add_fetch (&cache.header->clock, 1,
+                                       __ATOMIC_RELAXED);
+    uint32_t sequence = victim->sequence;
+    __atomic_store_n (&victim->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    __atomic_store_n (&victim->keyHash, key.hash, __ATOMIC_RELAXED);
+    __atomic_store_n (&victim->keyCheck, key.check, __ATOMIC_RELAXED);
+    __atomic_store_n (&victim->numOutputs, (uint32_t)outputs.size (),
+                      __ATOMIC_RELAXED);
+    for (size_t i = 0; i < outputs.size (); i++) {
+        __atomic_store_n (&victim->outputs[i], outputs[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n (&victim->cell0, cell0, __ATOMIC_RELAXED);
+    __atomic_store_n (&victim->lastUse, now, __ATOMIC_RELAXED);
+    __atomic_store_n (&victim->sequence, sequence + 2, __ATOMIC_RELEASE);
+    flock (cache.fd, LOCK_UN);
+    return true;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Partial evaluator: specialize an Intcode program for known input values.
+ *
+ * Intcode is deterministic, so with its inputs fixed, every value the program
+ * computes before it asks for an unknown input is a constant. The specializer
+ * therefore propagates the known inputs by running the program, which folds
+ * every branch taken on them, and emits a residual program for what is left:
+ *
+ *   - if the program halts on the known inputs, the residual is just its
+ *     outputs as "out #v" instructions and a halt; all code is dead
+ *   - if it asks for more input (or the step budget runs out), the residual
+ *     is the memory image at that point with a trampoline that replays the
+ *     outputs so far, restores the relative base and jumps to the pc where
+ *     the run stopped, so only the unknown part is executed again
+ *
+ * The trampoline starts with a jump at address 0 to code placed just past the
+ * end of the image, which puts the three overwritten cells back before
+ * resuming. The resumed program therefore sees a few extra nonzero cells past
+ * its original end; programs that write scratch memory before reading it, as
+ * every puzzle program does, behave identically.
+ */
+
+#ifndef INTCODE_SPECIALIZE_H
+#define INTCODE_SPECIALIZE_H
+
+#include <vector>
+
+#include "Intcode.h"
+
+struct SpecializeResult {
+    std::vector<long> residual;
+    // instructions folded away by running them ahead of time
+    long stepsFolded;
+    // outputs known ahead of time, replayed by the residual
+    std::vector<long> knownOutputs;
+    // the program halted: the residual is only outputs and a halt
+    bool complete;
+    // the program faulted on the known inputs; nothing was specialized
+    bool faulted;
+};
+
+/*
+ * Specialize program for the given known inputs, running at most maxSteps
+ * instructions ahead of time
+ */
+inline SpecializeResult specializeProgram (const std::vector<long> &program,
+                                           const std::vector<long> &inputs,
+                                           long maxSteps) {
+    SpecializeResult result;
+    IntcodeMachine machine;
+    initMachine (machine, program, inputs);
+    runDecoded (machine, maxSteps);
+    result.stepsFolded = machine.steps;
+    result.knownOutputs = machine.outputs;
+    result.complete = machine.status == INTCODE_HALTED;
+    result.faulted = machine.status == INTCODE_FAULT;
+
+    if (result.faulted) {
+        result.residual = program;
+        result.stepsFolded = 0;
+        result.knownOutputs.clear ();
+        return result;
+    }
+    if (result.complete) {
+        for (long value : machine.outputs) {
+            result.residual.push_back (104);
+            result.residual.push_back (value);
+        }
+        result.residual.push_back (99);
+        return result;
+    }
+
+    // resume image: memory as it is now, entered through a trampoline
+    std::vector<long> &image = result.residual;
+    image = machine.memory;
+    while (image.size () < 3) {
+        image.push_back (0);
+    }
+    long trampoline = image.size ();
+    long saved[3] = {image[0], image[1], image[2]};
+    image[0] = 1105;
+    image[1] = 1;
+    image[2] = trampoline;
+    for (long value : machine.outputs) {
+        image.push_back (104);
+        image.push_back (value);
+    }
+    for (long address = 0; address < 3; address++) {
+        image.push_back (1101);
+        image.push_back (saved[address]);
+        image.push_back (0);
+        image.push_back (address);
+    }
+    if (machine.relativeBase != 0) {
+        image.push_back (109);
+        image.push_back (machine.relativeBase);
+    }
+    image.push_back (1105);
+    image.push_back (1);
+    image.push_back (machine.pc);
+    return result;
+}
+
+#endif
@@ -0,0 +1,496 @@
+/*
+ * Loop summarization for the summarizing Intcode engine, included by
+ * Intcode.h.
+ *
+ * Whenever the engine takes a backward jump from J to H, it asks
+ * summarizeLoop whether the code from H to J is a simple counted loop:
+ *
+ *   - straight-line add, mul, lt and eq instructions, plus jumps that are
+ *     never taken; no input, output, relative base change or halt
+ *   - exactly one exit: either J itself is conditional, or J always jumps
+ *     back and one conditional jump in the body leaves the loop
+ *   - no writes into the loop's own code, every address inside memory
+ *
+ * One iteration is executed symbolically, giving every written cell an affine
+ * expression over the cell values at the start of the iteration. The loop is
+ * summarized when every cell read before being written is
+ *
+ *   - invariant (never written in the loop), or
+ *   - linear, c += d with d invariant: a counter or a repeated addition, or
+ *   - quadratic, c += d with d linear, used only by its own update: a sum
+ *
+ * and the exit condition is an affine function of invariant and linear cells,
+ * so it moves by a constant step each iteration and the first iteration that
+ * exits has a closed form. The engine then jumps straight to the start of the
+ * last iteration before that one, and runs the last two iterations normally,
+ * which rewrites every temporary and takes the exit exactly as the other
+ * engines would. Step counts, memory and wraparound all match.
+ *
+ * Everything else, including loops that never exit, falls back to normal
+ * execution. A loop that fails is left alone for a while, doubling each time,
+ * so nested and data-dependent loops cost little analysis.
+ */
+
+#ifndef INTCODE_SUMMARIZE_H
+#define INTCODE_SUMMARIZE_H
+
+#include <map>
+
+// loops skipping fewer iterations than this are not worth analysing again
+const long summarizeMinIterations = 8;
+
+typedef __int128 SummarizeInt;
+
+/*
+ * Affine expression over cell values at the start of an iteration:
+ * constant + sum of coefs[address] * cell[address], kept exact
+ */
+struct AffineExpr {
+    SummarizeInt constant;
+    std::map<long, SummarizeInt> coefs;
+};
+
+/*
+ * Symbolic value of a cell or operand during one iteration
+ */
+struct SymbolicValue {
+    enum {AFFINE, COMPARE, OPAQUE} kind;
+    AffineExpr expr;
+    // COMPARE: lt (opcode 7) or eq (opcode 8) of expr and other
+    long compareOp;
+    AffineExpr other;
+};
+
+// helper function to add scale * b into a, false on overflow
+inline bool addScaled (AffineExpr &a, const AffineExpr &b,
+                       SummarizeInt scale) {
+    SummarizeInt term;
+    if (__builtin_mul_overflow (b.constant, scale, &term) ||
+        __builtin_add_overflow (a.constant, term, &a.constant)) {
+        return false;
+    }
+    for (const std::pair<const long, SummarizeInt> &coef : b.coefs) {
+        SummarizeInt &target = a.coefs[coef.first];
+        if (__builtin_mul_overflow (coef.second, scale, &term) ||
+            __builtin_add_overflow (target, term, &target)) {
+            return false;
+        }
+        if (target == 0) {
+            a.coefs.erase (coef.first);
+        }
+    }
+    return true;
+}
+
+/*
+ * Classification of a cell read before it is written in the loop body
+ */
+struct LoopCell {
+    enum {INVARIANT, LINEAR, QUADRATIC} kind;
+    // cell value now, at the start of the first iteration to skip
+    long value;
+    // change per iteration: constant for linear cells, an expression over
+    // invariant and linear cells for quadratic ones
+    SummarizeInt step;
+    AffineExpr delta;
+};
+
+// helper function to evaluate an expression now (start) and its change per
+// iteration (slope), false on overflow or a term that is not linear
+inline bool evalLinear (const AffineExpr &expr,
+                        const std::map<long, LoopCell> &cells,
+                        SummarizeInt &start, SummarizeInt &slope) {
+    start = expr.constant;
+    slope = 0;
+    for (const std::pair<const long, SummarizeInt> &coef : expr.coefs) {
+        const LoopCell &cell = cells.at (coef.first);
+        SummarizeInt term;
+        if (cell.kind == LoopCell::QUADRATIC ||
+            __builtin_mul_overflow (coef.second, (SummarizeInt)cell.value,
+                                    &term) ||
+            __builtin_add_overflow (start, term, &start) ||
+            __builtin_mul_overflow (coef.second, cell.step, &term) ||
+            __builtin_add_overflow (slope, term, &slope)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// helper function to check an expression stays within long for iterations
+// [0, last], so the wrapped values the engines compare are the exact ones
+inline bool staysInRange (SummarizeInt start, SummarizeInt slope, long last) {
+    SummarizeInt end;
+    if (__builtin_mul_overflow (slope, (SummarizeInt)last, &end) ||
+        __builtin_add_overflow (end, start, &end)) {
+        return false;
+    }
+    return start >= LONG_MIN && start <= LONG_MAX && end >= LONG_MIN &&
+           end <= LONG_MAX;
+}
+
+/*
+ * First iteration n >= 0 where start + n * slope satisfies the exit test
+ * (0: > 0, 1: <= 0, 2: == 0, 3: != 0), or -1 if it never does
+ */
+inline SummarizeInt firstExit (int test, SummarizeInt start,
+                               SummarizeInt slope) {
+    switch (test) {
+        case 0 :
+            if (start > 0) {
+                return 0;
+            }
+            return slope > 0 ? -start / slope + 1 : -1;
+        case 1 :
+            if (start <= 0) {
+                return 0;
+            }
+            return slope < 0 ? (start - slope - 1) / -slope : -1;
+        case 2 :
+            if (start == 0) {
+                return 0;
+            }
+            if (slope == 0 || -start % slope != 0 || -start / slope < 0) {
+                return -1;
+            }
+            return -start / slope;
+        default :
+            if (start != 0) {
+                return 0;
+            }
+            return slope != 0 ? 1 : -1;
+    }
+}
+
+/*
+ * Analyse the loop from head to the backward jump at jumpPc, just taken, and
+ * skip as many whole iterations as it safely can within maxSteps. Returns the
+ * number of instructions skipped, 0 if the loop is not summarized.
+ */
+inline long analyseLoop (IntcodeMachine &machine, long head, long jumpPc,
+                         long relativeBase, long maxSteps) {
+    std::vector<long> &memory = machine.memory;
+    long size = memory.size ();
+    long codeEnd = jumpPc + 3;
+    if (head < 0 || codeEnd > size) {
+        return 0;
+    }
+
+    // symbolic execution of one iteration
+    std::map<long, SymbolicValue> written;
+    std::map<long, LoopCell> cells;
+    bool haveExit = false;
+    SymbolicValue exitValue;
+    bool exitWhenTaken = false;
+    bool exitOnJnz = false;
+    long length = 0;
+    long pc = head;
+    while (pc <= jumpPc) {
+        long word = memory[pc];
+        long opcode = word % 100;
+        int numParams = intcodeNumParams (opcode);
+        if (word < 0 || numParams < 0 || opcode == 3 || opcode == 4 ||
+            opcode == 9 || opcode == 99 || pc + numParams >= codeEnd) {
+            return 0;
+        }
+        // operands: immediate values, or addresses read from start values
+        SymbolicValue operands[3];
+        long addresses[3];
+        long modeDigits = word / 100;
+        for (int i = 0; i < numParams; i++) {
+            long mode = modeDigits % 10;
+            modeDigits /= 10;
+            long param = memory[pc + 1 + i];
+            bool write = intcodeIsWrite (opcode, i);
+            if (mode > 2) {
+                return 0;
+            }
+            operands[i].kind = SymbolicValue::AFFINE;
+            operands[i].expr.constant = param;
+            if (mode == 1 && !write) {
+                continue;
+            }
+            long address = param;
+            if (mode == 2 && __builtin_add_overflow (param, relativeBase,
+                                                     &address)) {
+                return 0;
+            }
+            if (address < 0 || address >= size) {
+                return 0;
+            }
+            addresses[i] = address;
+            if (write) {
+                continue;
+            }
+            std::map<long, SymbolicValue>::iterator found;
+            found = written.find (address);
+            if (found != written.end ()) {
+                operands[i] = found->second;
+                continue;
+            }
+            operands[i].expr.constant = 0;
+            operands[i].expr.coefs[address] = 1;
+            cells[address].value = memory[address];
+        }
+
+        if (opcode == 5 || opcode == 6) {
+            bool immediate = (word / 100) % 10 == 1;
+            bool taken = (opcode == 5) == (memory[pc + 1] != 0);
+            // the jump target must not change from one iteration to the next
+            if ((word / 1000) % 10 != 1 && written.count (addresses[1])) {
+                return 0;
+            }
+            if (pc == jumpPc && immediate && !taken) {
+                return 0;
+            }
+            if (immediate && pc != jumpPc) {
+                // never-taken jumps are no-ops; any other leaves the body
+                if (taken) {
+                    return 0;
+                }
+            }
+            else if (!immediate) {
+                if (haveExit) {
+                    return 0;
+                }
+                haveExit = true;
+                exitValue = operands[0];
+                exitOnJnz = opcode == 5;
+                // the closing jump exits by falling through
+                exitWhenTaken = pc != jumpPc;
+                if (exitWhenTaken && operands[1].kind ==
+                    SymbolicValue::AFFINE && operands[1].expr.coefs.empty ()) {
+                    long target = operands[1].expr.constant;
+                    if (target >= head && target < codeEnd) {
+                        return 0;
+                    }
+                }
+                else if (exitWhenTaken) {
+                    return 0;
+                }
+            }
+            pc += 3;
+            length++;
+            continue;
+        }
+
+        long address = addresses[2];
+        if (address >= head && address < codeEnd) {
+            return 0;
+        }
+        SymbolicValue result;
+        result.kind = SymbolicValue::OPAQUE;
+        bool affine = operands[0].kind == SymbolicValue::AFFINE &&
+                      operands[1].kind == SymbolicValue::AFFINE;
+        if (affine && opcode == 1) {
+            result = operands[0];
+            if (!addScaled (result.expr, operands[1].expr, 1)) {
+                return 0;
+            }
+        }
+        else if (affine && opcode == 2) {
+            // affine only when one side is a constant
+            int scaled = operands[0].expr.coefs.empty () ? 1 : 0;
+            if (operands[1 - scaled].expr.coefs.empty ()) {
+                result.kind = SymbolicValue::AFFINE;
+                result.expr.constant = 0;
+                if (!addScaled (result.expr, operands[scaled].expr,
+                                operands[1 - scaled].expr.constant)) {
+                    return 0;
+                }
+            }
+        }
+        else if (affine) {
+            result.kind = SymbolicValue::COMPARE;
+            result.compareOp = opcode;
+            result.expr = operands[0].expr;
+            result.other = operands[1].expr;
+        }
+        written[address] = result;
+        pc += 4;
+        length++;
+    }
+    if (pc != jumpPc + 3 || !haveExit) {
+        return 0;
+    }
+
+    // classify every cell read before it was written
+    for (std::pair<const long, LoopCell> &entry : cells) {
+        LoopCell &cell = entry.second;
+        std::map<long, SymbolicValue>::iterator found;
+        found = written.find (entry.first);
+        if (found == written.end ()) {
+            cell.kind = LoopCell::INVARIANT;
+            cell.step = 0;
+            continue;
+        }
+        // must be c += delta, delta not involving c
+        const SymbolicValue &update = found->second;
+        if (update.kind != SymbolicValue::AFFINE) {
+            return 0;
+        }
+        std::map<long, SummarizeInt>::const_iterator self;
+        self = update.expr.coefs.find (entry.first);
+        if (self == update.expr.coefs.end () || self->second != 1) {
+            return 0;
+        }
+        cell.delta = update.expr;
+        cell.delta.coefs.erase (entry.first);
+        cell.kind = LoopCell::LINEAR;
+    }
+    for (std::pair<const long, LoopCell> &entry : cells) {
+        LoopCell &cell = entry.second;
+        if (cell.kind != LoopCell::LINEAR) {
+            continue;
+        }
+        for (const std::pair<const long, SummarizeInt> &coef :
+             cell.delta.coefs) {
+            if (cells.at (coef.first).kind != LoopCell::INVARIANT) {
+                cell.kind = LoopCell::QUADRATIC;
+            }
+        }
+        if (cell.kind == LoopCell::LINEAR) {
+            SummarizeInt slope;
+            if (!evalLinear (cell.delta, cells, cell.step, slope)) {
+                return 0;
+            }
+        }
+    }
+    // quadratic deltas must be linear, and nothing else may read a sum
+    for (std::pair<const long, SymbolicValue> &entry : written) {
+        const SymbolicValue &value = entry.second;
+        for (const AffineExpr *expr : {&value.expr, &value.other}) {
+            if (value.kind == SymbolicValue::OPAQUE ||
+                (expr == &value.other &&
+                 value.kind != SymbolicValue::COMPARE)) {
+                continue;
+            }
+            for (const std::pair<const long, SummarizeInt> &coef :
+                 expr->coefs) {
+                if (coef.first != entry.first &&
+                    cells.at (coef.first).kind == LoopCell::QUADRATIC) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    // exit test as start + n * slope against zero
+    SummarizeInt start;
+    SummarizeInt slope;
+    SummarizeInt otherStart = 0;
+    SummarizeInt otherSlope = 0;
+    int test;
+    if (exitValue.kind == SymbolicValue::OPAQUE ||
+        !evalLinear (exitValue.expr, cells, start, slope)) {
+        return 0;
+    }
+    // jump taken when value != 0 (jnz) or == 0 (jz)
+    bool exitOnNonzero = exitOnJnz == exitWhenTaken;
+    if (exitValue.kind == SymbolicValue::COMPARE) {
+        if (!evalLinear (exitValue.other, cells, otherStart, otherSlope)) {
+            return 0;
+        }
+        // a < b is b - a > 0, a == b is a - b == 0
+        SummarizeInt diffStart;
+        SummarizeInt diffSlope;
+        if (__builtin_sub_overflow (otherStart, start, &diffStart) ||
+            __builtin_sub_overflow (otherSlope, slope, &diffSlope)) {
+            return 0;
+        }
+        if (exitValue.compareOp == 7) {
+            test = exitOnNonzero ? 0 : 1;
+        }
+        else {
+            test = exitOnNonzero ? 2 : 3;
+        }
+        start = diffStart;
+        slope = diffSlope;
+    }
+    else {
+        test = exitOnNonzero ? 3 : 2;
+    }
+    SummarizeInt exitIteration = firstExit (test, start, slope);
+    if (exitIteration < 0) {
+        return 0;
+    }
+
+    // skip every iteration before the last full one, leaving room in the step
+    // budget to run one iteration normally, which rewrites the temporaries
+    SummarizeInt skip = exitIteration - 1;
+    if (skip > maxSteps / length - 1) {
+        skip = maxSteps / length - 1;
+    }
+    if (skip < summarizeMinIterations) {
+        return 0;
+    }
+    long iterations = skip;
+    // the compared values must not wrap while deciding the skipped iterations
+    if (exitValue.kind == SymbolicValue::COMPARE) {
+        if (!evalLinear (exitValue.expr, cells, start, slope) ||
+            !staysInRange (start, slope, iterations - 1) ||
+            !staysInRange (otherStart, otherSlope, iterations - 1)) {
+            return 0;
+        }
+    }
+    else if (!staysInRange (start, slope, iterations - 1)) {
+        return 0;
+    }
+
+    // closed forms, in wrapping arithmetic like the engines
+    std::map<long, unsigned long> results;
+    for (std::pair<const long, LoopCell> &entry : cells) {
+        const LoopCell &cell = entry.second;
+        unsigned long value = cell.value;
+        if (cell.kind == LoopCell::LINEAR) {
+            value += (unsigned long)iterations * (unsigned long)cell.step;
+        }
+        else if (cell.kind == LoopCell::QUADRATIC) {
+            // sum of delta over the iterations: n * delta0 + slope * n(n-1)/2
+            SummarizeInt deltaStart;
+            SummarizeInt deltaSlope;
+            if (!evalLinear (cell.delta, cells, deltaStart, deltaSlope)) {
+                return 0;
+            }
+            unsigned __int128 pairs = (unsigned __int128)iterations *
+                                      (iterations - 1) / 2;
+            value += (unsigned long)iterations * (unsigned long)deltaStart +
+                     (unsigned long)pairs * (unsigned long)deltaSlope;
+        }
+        else {
+            continue;
+        }
+        results[entry.first] = value;
+    }
+    for (std::pair<const long, unsigned long> &result : results) {
+        memory[result.first] = (long)result.second;
+        if (result.first < (long)machine.decoded.size ()) {
+            machine.decoded[result.first] = 0;
+        }
+    }
+    return iterations * length;
+}
+
+inline long summarizeLoop (IntcodeMachine &machine, long head, long jumpPc,
+                           long relativeBase, long maxSteps) {
+    if (jumpPc >= (long)machine.loopHints.size ()) {
+        machine.loopHints.resize (jumpPc + 1, IntcodeLoopHint {0, 0});
+    }
+    IntcodeLoopHint &hint = machine.loopHints[jumpPc];
+    if (hint.skip > 0) {
+        hint.skip--;
+        return 0;
+    }
+    long skipped = analyseLoop (machine, head, jumpPc, relativeBase,
+                                maxSteps);
+    if (skipped == 0) {
+        hint.failures = hint.failures < 16 ? hint.failures + 1 : 16;
+        hint.skip = 1u << hint.failures;
+    }
+    else {
+        hint.failures = 0;
+    }
+    return skipped;
+}
+
+#endif
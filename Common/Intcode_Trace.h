@@ -0,0 +1,208 @@
+/*
+ * Memory access tracer for Intcode programs.
+ *
+ * runTraced executes a machine one instruction at a time on the switch
+ * engine, first recording through the checked decoder every cell the
+ * instruction fetches, reads and writes, and where the relative base goes.
+ * At halt, printTraceSummary classifies the touched cells and reports the
+ * working set:
+ *
+ *   - code cells (fetched, never written) versus self-modified code
+ *   - read-only data versus scratch cells that are written
+ *   - the hottest cells, candidates for registers in a compiled engine
+ *   - the peak address touched, which accessInput's resize used to hide
+ *   - relative base range and the addresses reached through it
+ *   - pages touched for several page sizes, to size sparse memory pages
+ *
+ * Tracing is slow and separate from the engines; nothing pays for it unless
+ * runTraced is used.
+ */
+
+#ifndef INTCODE_TRACE_H
+#define INTCODE_TRACE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "Intcode.h"
+
+struct MemoryTrace {
+    // per address counts, grown to the highest address touched
+    std::vector<uint32_t> fetches;
+    std::vector<uint32_t> reads;
+    std::vector<uint32_t> writes;
+    long peakAddress;
+    long steps;
+    // relative base excursions
+    long minBase;
+    long maxBase;
+    long baseChanges;
+    // effective addresses of relative mode accesses
+    long minRelative;
+    long maxRelative;
+    long relativeAccesses;
+};
+
+inline void initTrace (MemoryTrace &trace) {
+    trace.fetches.clear ();
+    trace.reads.clear ();
+    trace.writes.clear ();
+    trace.peakAddress = -1;
+    trace.steps = 0;
+    trace.minBase = trace.maxBase = 0;
+    trace.baseChanges = 0;
+    trace.minRelative = LONG_MAX;
+    trace.maxRelative = LONG_MIN;
+    trace.relativeAccesses = 0;
+}
+
+// helper function to bump one counter, growing the counters to fit
+inline void countAccess (MemoryTrace &trace, std::vector<uint32_t> &counts,
+                         long address) {
+    if (address >= (long)trace.fetches.size ()) {
+        size_t size = std::max ((size_t)address + 1, trace.fetches.size () * 2);
+        trace.fetches.resize (size, 0);
+        trace.reads.resize (size, 0);
+        trace.writes.resize (size, 0);
+    }
+    if (counts[address] != UINT32_MAX) {
+        counts[address]++;
+    }
+    trace.peakAddress = std::max (trace.peakAddress, address);
+}
+
+/*
+ * Run up to maxSteps instructions, recording each one into trace
+ */
+inline long runTraced (IntcodeMachine &machine, MemoryTrace &trace,
+                       long maxSteps) {
+    long steps = 0;
+    while (steps < maxSteps && machine.status != INTCODE_HALTED &&
+           machine.status != INTCODE_FAULT) {
+        // decode without side effects; stopped machines are left to the engine
+        IntcodeInstruction instr;
+        const char *faultReason = nullptr;
+        long pc = machine.pc;
+        bool valid = pc < (long)machine.memory.size () &&
+                     decodeInstruction (machine, instr, faultReason);
+        if (runSwitch (machine, 1) == 0) {
+            break;
+        }
+        steps++;
+        if (!valid) {
+            continue;
+        }
+        for (long i = 0; i <= instr.numParams; i++) {
+            countAccess (trace, trace.fetches, pc + i);
+        }
+        for (int i = 0; i < instr.numParams; i++) {
+            long address = instr.addresses[i];
+            if (address < 0) {
+                continue;
+            }
+            bool write = intcodeIsWrite (instr.opcode, i);
+            countAccess (trace, write ? trace.writes : trace.reads, address);
+            if (instr.modes[i] == 2) {
+                trace.minRelative = std::min (trace.minRelative, address);
+                trace.maxRelative = std::max (trace.maxRelative, address);
+                trace.relativeAccesses++;
+            }
+        }
+        if (instr.opcode == 9) {
+            trace.baseChanges++;
+            trace.minBase = std::min (trace.minBase, machine.relativeBase);
+            trace.maxBase = std::max (trace.maxBase, machine.relativeBase);
+        }
+    }
+    trace.steps += steps;
+    return steps;
+}
+
+/*
+ * Print the working-set summary of a finished trace
+ */
+inline void printTraceSummary (const MemoryTrace &trace, FILE *out) {
+    long code = 0;
+    long modifiedCode = 0;
+    long readOnly = 0;
+    long scratch = 0;
+    long touched = 0;
+    std::vector<std::pair<uint64_t, long>> hot;
+    for (long a = 0; a < (long)trace.fetches.size (); a++) {
+        uint64_t fetches = trace.fetches[a];
+        uint64_t reads = trace.reads[a];
+        uint64_t writes = trace.writes[a];
+        if (!fetches && !reads && !writes) {
+            continue;
+        }
+        touched++;
+        if (fetches) {
+            (writes ? modifiedCode : code)++;
+        }
+        else if (writes) {
+            scratch++;
+        }
+        else {
+            readOnly++;
+        }
+        if (reads + writes) {
+            hot.push_back ({reads + writes, a});
+        }
+    }
+
+    fprintf (out, "instructions:        %ld\n", trace.steps);
+    fprintf (out, "peak address:        %ld\n", trace.peakAddress);
+    fprintf (out, "cells touched:       %ld\n", touched);
+    fprintf (out, "  code (read-only):  %ld\n", code);
+    fprintf (out, "  self-modified:     %ld\n", modifiedCode);
+    fprintf (out, "  read-only data:    %ld\n", readOnly);
+    fprintf (out, "  scratch (written): %ld\n", scratch);
+    fprintf (out, "relative base:       %ld changes, range [%ld, %ld]\n",
+             trace.baseChanges, trace.minBase, trace.maxBase);
+    if (trace.relativeAccesses) {
+        fprintf (out, "relative accesses:   %ld, addresses [%ld, %ld]\n",
+                 trace.relativeAccesses, trace.minRelative,
+                 trace.maxRelative);
+    }
+    else {
+        fprintf (out, "relative accesses:   none\n");
+    }
+
+    // hottest data cells by reads plus writes
+    size_t numHot = std::min (hot.size (), (size_t)10);
+    std::partial_sort (hot.begin (), hot.begin () + numHot, hot.end (),
+                       [] (const std::pair<uint64_t, long> &a,
+                           const std::pair<uint64_t, long> &b) {
+                           return a.first > b.first;
+                       });
+    fprintf (out, "hottest cells:\n");
+    for (size_t i = 0; i < numHot; i++) {
+        long a = hot[i].second;
+        fprintf (out, "  [%ld] %u reads, %u writes%s\n", a, trace.reads[a],
+                 trace.writes[a], trace.fetches[a] ? " (code)" : "");
+    }
+
+    // resident words if memory were allocated in pages of each size
+    fprintf (out, "pages touched:\n");
+    for (long pageSize : {16L, 64L, 256L, 1024L, 4096L}) {
+        long pages = 0;
+        for (long start = 0; start < (long)trace.fetches.size ();
+             start += pageSize) {
+            long end = std::min (start + pageSize,
+                                 (long)trace.fetches.size ());
+            for (long a = start; a < end; a++) {
+                if (trace.fetches[a] || trace.reads[a] || trace.writes[a]) {
+                    pages++;
+                    break;
+                }
+            }
+        }
+        fprintf (out, "  %5ld words: %ld pages, %ld words resident (%.1f%% "
+                 "used)\n", pageSize, pages, pages * pageSize,
+                 pages ? 100.0 * touched / (pages * pageSize) : 0.0);
+    }
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Multi-threaded reducer for line-oriented numeric inputs.
+ *
+ * reduceFile memory maps a file and splits it into one chunk per thread, each
+ * moved forward to start just after a newline so no number is cut in two.
+ * Every thread parses its chunk in place into blocks of numbers and feeds them
+ * to its own copy of the reducer; the copies are then merged into the result
+ * in chunk order.
+ *
+ * The reducer is pluggable. It is any default constructible type with
+ *
+ *     void add (const long *values, size_t count);
+ *     void merge (const Reducer &other);
+ *
+ * add receives the numbers of a chunk in input order, at most blockValues at a
+ * time. A number is an optional '-' followed by digits; any other character
+ * separates numbers.
+ */
+
+#ifndef LINE_REDUCER_H
+#define LINE_REDUCER_H
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Mapped_File.h"
+
+// numbers handed to the reducer per add call
+const size_t blockValues = 4096;
+
+/*
+ * Parse the numbers of text[0, size) into the reducer
+ */
+template <typename Reducer>
+void reduceText (const char *text, size_t size, Reducer &reducer) {
+    long block [blockValues];
+    size_t blockSize = 0;
+    size_t i = 0;
+    while (i < size) {
+        // skip to the start of the next number
+        while (i < size && (text[i] < '0' || text[i] > '9')) {
+            i++;
+        }
+        if (i == size) {
+            break;
+        }
+        bool negative = i > 0 && text[i - 1] == '-';
+        long value = 0;
+        while (i < size && text[i] >= '0' && text[i] <= '9') {
+            value = value * 10 + (text[i++] - '0');
+        }
+        block[blockSize++] = negative ? -value : value;
+        if (blockSize == blockValues) {
+            reducer.add (block, blockSize);
+            blockSize = 0;
+        }
+    }
+    reducer.add (block, blockSize);
+}
+
+/*
+ * Reduce the numbers of the file at path with numThreads threads, one per
+ * core if 0. Returns false if the file cannot be mapped; an empty file is
+ * reduced to a default constructed result.
+ */
+template <typename Reducer>
+bool reduceFile (const char *path, Reducer &result, unsigned numThreads = 0) {
+    result = Reducer ();
+    MappedFile file (path);
+    if (file.data == nullptr) {
+        struct stat info;
+        return stat (path, &info) == 0 && info.st_size == 0;
+    }
+    if (numThreads == 0) {
+        numThreads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+    madvise ((void *)file.data, file.size, MADV_SEQUENTIAL);
+
+    // chunk boundaries, each just after a newline or at either end
+    std::vector<size_t> bounds (numThreads + 1, file.size);
+    bounds[0] = 0;
+    for (unsigned t = 1; t < numThreads; t++) {
+        size_t start = std::max (bounds[t - 1], file.size / numThreads * t);
+        if (start > 0 && start < file.size && file.data[start - 1] != '\n') {
+            const char *newline = (const char *)memchr (
+                file.data + start, '\n', file.size - start);
+            start = newline == nullptr ? file.size :
+                    newline - file.data + 1;
+        }
+        bounds[t] = start;
+    }
+
+    // the first chunk is reduced on this thread while the others run
+    std::vector<Reducer> partials (numThreads);
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; t++) {
+        threads.emplace_back ([&, t] () {
+            reduceText (file.data + bounds[t], bounds[t + 1] - bounds[t],
+                        partials[t]);
+        });
+    }
+    reduceText (file.data, bounds[1], partials[0]);
+    for (std::thread &thread : threads) {
+        thread.join ();
+    }
+    for (const Reducer &partial : partials) {
+        result.merge (partial);
+    }
+    return true;
+}
+
+#endif
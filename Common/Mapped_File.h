@@ -0,0 +1,50 @@
+/*
+ * Read-only memory mapping of a whole file, for the loaders and parsers that
+ * read their input in place instead of copying it into strings.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Mapping of the file at path, unmapped on destruction. data is null if the
+ * file cannot be opened, or is empty.
+ */
+struct MappedFile {
+    const char *data;
+    size_t size;
+
+    MappedFile (const char *path) : data (nullptr), size (0) {
+        int fd = open (path, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat (fd, &info) == 0 && info.st_size > 0) {
+            void *addr = mmap (nullptr, info.st_size, PROT_READ, MAP_PRIVATE,
+                               fd, 0);
+            if (addr != MAP_FAILED) {
+                data = (const char *)addr;
+                size = info.st_size;
+            }
+        }
+        close (fd);
+    }
+
+    ~MappedFile () {
+        if (data != nullptr) {
+            munmap ((void *)data, size);
+        }
+    }
+
+    MappedFile (const MappedFile &) = delete;
+    MappedFile &operator = (const MappedFile &) = delete;
+};
+
+#endif
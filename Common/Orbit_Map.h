@@ -0,0 +1,287 @@
+/*
+ * Flat storage for orbit maps (Day 6).
+ *
+ * Object names are interned while parsing into dense integer IDs: the names
+ * are copied once into a single character arena, and an open-addressing table
+ * of IDs, probed by hashing the name, finds an existing ID. The tree is then
+ * kept as flat arrays indexed by ID: the parent of each object, its children
+ * as one CSR array (the children of id are children[childOffsets[id],
+ * childOffsets[id + 1])), its depth below the root, and a breadth-first order
+ * in which every parent comes before its children. Every traversal is a
+ * linear scan of these arrays, at a few tens of bytes per object.
+ *
+ * The map is read in place from a memory mapped file of "A)B" lines, B
+ * orbiting A. Names may be of any length.
+ *
+ * Transfers between two objects are depth (A) + depth (B) - 2 depth (LCA),
+ * with the lowest common ancestor found through a jump pointer per object, a
+ * form of binary lifting that needs one pointer rather than log n of them. An
+ * object's jump skips a power-of-two-like distance up the tree, chosen from
+ * its parent's jumps so that any ancestor is reached in O(log n) jumps; the
+ * pointers are set in the same breadth-first scan as the depths.
+ */
+
+#ifndef ORBIT_MAP_H
+#define ORBIT_MAP_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Mapped_File.h"
+
+struct OrbitMap {
+    // names of all objects, back to back; id's name starts at nameOffsets[id]
+    std::string names;
+    std::vector<uint32_t> nameOffsets;
+    // IDs by hash of their name, -1 for an empty slot
+    std::vector<int> nameTable;
+
+    // object directly orbited, -1 for a root such as COM
+    std::vector<int> parent;
+    std::vector<int> childOffsets;
+    std::vector<int> children;
+    // orbits of each object, -1 if it is on a cycle and never reached
+    std::vector<int> depth;
+    // objects from the roots down, parents first
+    std::vector<int> order;
+    // ancestor each object jumps to when climbing quickly
+    std::vector<int> jump;
+
+    int size () const {
+        return parent.size ();
+    }
+};
+
+// helper function to hash an object name
+inline uint64_t hashName (const char *name, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// helper function to compare id's interned name with a name
+inline bool nameEquals (const OrbitMap &map, int id, const char *name,
+                        size_t length) {
+    size_t begin = map.nameOffsets[id];
+    return map.nameOffsets[id + 1] - begin == length &&
+           memcmp (map.names.data () + begin, name, length) == 0;
+}
+
+// helper function to probe for a name: its slot, or the empty slot for it
+inline size_t findNameSlot (const OrbitMap &map, const char *name,
+                            size_t length) {
+    size_t mask = map.nameTable.size () - 1;
+    size_t slot = hashName (name, length) & mask;
+    while (map.nameTable[slot] != -1 &&
+           !nameEquals (map, map.nameTable[slot], name, length)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*
+ * ID of a name, added with the next ID if it is new
+ */
+inline int internName (OrbitMap &map, const char *name, size_t length) {
+    size_t slot = findNameSlot (map, name, length);
+    if (map.nameTable[slot] != -1) {
+        return map.nameTable[slot];
+    }
+    int id = map.nameOffsets.size () - 1;
+    map.names.append (name, length);
+    map.nameOffsets.push_back (map.names.size ());
+    map.nameTable[slot] = id;
+    // keep the table at most half full, rehashing into double the slots
+    if (2 * (size_t)(id + 1) > map.nameTable.size ()) {
+        map.nameTable.assign (2 * map.nameTable.size (), -1);
+        for (int other = 0; other <= id; other++) {
+            size_t begin = map.nameOffsets[other];
+            map.nameTable[findNameSlot (map, map.names.data () + begin,
+                                        map.nameOffsets[other + 1] - begin)] =
+                other;
+        }
+    }
+    return id;
+}
+
+/*
+ * ID of an object by name, -1 if the map has no such object
+ */
+inline int findObject (const OrbitMap &map, const std::string &name) {
+    if (map.nameTable.empty ()) {
+        return -1;
+    }
+    return map.nameTable[findNameSlot (map, name.data (), name.size ())];
+}
+
+/*
+ * Name of an object by ID
+ */
+inline std::string objectName (const OrbitMap &map, int id) {
+    return map.names.substr (map.nameOffsets[id],
+                             map.nameOffsets[id + 1] - map.nameOffsets[id]);
+}
+
+// helper function to build the CSR children, depths and order from parents
+inline void linkOrbits (OrbitMap &map) {
+    int numObjects = map.size ();
+    map.childOffsets.assign (numObjects + 1, 0);
+    for (int id = 0; id < numObjects; id++) {
+        if (map.parent[id] >= 0) {
+            map.childOffsets[map.parent[id] + 1]++;
+        }
+    }
+    for (int id = 0; id < numObjects; id++) {
+        map.childOffsets[id + 1] += map.childOffsets[id];
+    }
+    map.children.resize (map.childOffsets[numObjects]);
+    std::vector<int> fill (map.childOffsets.begin (),
+                           map.childOffsets.end () - 1);
+    for (int id = 0; id < numObjects; id++) {
+        if (map.parent[id] >= 0) {
+            map.children[fill[map.parent[id]]++] = id;
+        }
+    }
+
+    // breadth first from the roots; order doubles as the queue. objects on
+    // a cycle are never reached, and jump to themselves
+    map.depth.assign (numObjects, -1);
+    map.jump.resize (numObjects);
+    map.order.clear ();
+    map.order.reserve (numObjects);
+    for (int id = 0; id < numObjects; id++) {
+        map.jump[id] = id;
+        if (map.parent[id] < 0) {
+            map.depth[id] = 0;
+            map.order.push_back (id);
+        }
+    }
+    for (size_t next = 0; next < map.order.size (); next++) {
+        int id = map.order[next];
+        // two equal jumps in a row from the parent merge into one twice as
+        // long, otherwise the jump is a single step to the parent
+        int up = map.jump[id];
+        bool merge = map.parent[id] >= 0 &&
+                     map.depth[id] - map.depth[up] ==
+                     map.depth[up] - map.depth[map.jump[up]];
+        for (int c = map.childOffsets[id]; c < map.childOffsets[id + 1]; c++) {
+            int child = map.children[c];
+            map.depth[child] = map.depth[id] + 1;
+            map.jump[child] = merge ? map.jump[up] : id;
+            map.order.push_back (child);
+        }
+    }
+}
+
+/*
+ * Parse the "A)B" lines of the file at path into map. Returns false if the
+ * file cannot be read.
+ */
+inline bool loadOrbitMap (const char *path, OrbitMap &map) {
+    map = OrbitMap ();
+    map.nameOffsets.push_back (0);
+    map.nameTable.assign (1024, -1);
+    MappedFile file (path);
+    if (file.data == nullptr) {
+        return false;
+    }
+
+    const char *text = file.data;
+    const char *end = text + file.size;
+    while (text < end) {
+        const char *lineEnd = (const char *)memchr (text, '\n', end - text);
+        lineEnd = lineEnd == nullptr ? end : lineEnd;
+        const char *nameEnd = lineEnd;
+        if (nameEnd > text && nameEnd[-1] == '\r') {
+            nameEnd--;
+        }
+        const char *split = (const char *)memchr (text, ')', nameEnd - text);
+        if (split != nullptr) {
+            int base = internName (map, text, split - text);
+            int orbiter = internName (map, split + 1, nameEnd - split - 1);
+            map.parent.resize (map.nameOffsets.size () - 1, -1);
+            map.parent[orbiter] = base;
+        }
+        text = lineEnd + 1;
+    }
+    map.parent.resize (map.nameOffsets.size () - 1, -1);
+    linkOrbits (map);
+    return true;
+}
+
+/*
+ * Total direct and indirect orbits: the sum of all depths
+ */
+inline long totalOrbits (const OrbitMap &map) {
+    long total = 0;
+    for (int depth : map.depth) {
+        total += depth > 0 ? depth : 0;
+    }
+    return total;
+}
+
+/*
+ * Lowest common ancestor of two objects, -1 if they are not connected
+ */
+inline int commonAncestor (const OrbitMap &map, int a, int b) {
+    if (a < 0 || b < 0 || map.depth[a] < 0 || map.depth[b] < 0) {
+        return -1;
+    }
+    if (map.depth[a] < map.depth[b]) {
+        std::swap (a, b);
+    }
+    // climb a to b's depth, jumping whenever that does not overshoot
+    while (map.depth[a] > map.depth[b]) {
+        a = map.depth[map.jump[a]] >= map.depth[b] ? map.jump[a] :
+            map.parent[a];
+    }
+    // at equal depths the jumps are equally long: jump both unless that
+    // would pass the common ancestor
+    while (a != b) {
+        // a root jumps to itself, so step instead
+        if (map.jump[a] != map.jump[b] && map.jump[a] != a) {
+            a = map.jump[a];
+            b = map.jump[b];
+        }
+        else {
+            a = map.parent[a];
+            b = map.parent[b];
+            if (a < 0) {
+                // different roots
+                return -1;
+            }
+        }
+    }
+    return a;
+}
+
+/*
+ * Orbital transfers to move from object from to object to, -1 if they are
+ * not connected
+ */
+inline long transfers (const OrbitMap &map, int from, int to) {
+    int ancestor = commonAncestor (map, from, to);
+    if (ancestor < 0) {
+        return -1;
+    }
+    return (long)map.depth[from] + map.depth[to] - 2L * map.depth[ancestor];
+}
+
+/*
+ * Transfers for a batch of (from, to) queries, into results
+ */
+inline void transfers (const OrbitMap &map,
+                       const std::vector<std::pair<int, int>> &queries,
+                       std::vector<long> &results) {
+    results.resize (queries.size ());
+    for (size_t q = 0; q < queries.size (); q++) {
+        results[q] = transfers (map, queries[q].first, queries[q].second);
+    }
+}
+
+#endif
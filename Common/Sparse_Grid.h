@@ -0,0 +1,224 @@
+/*
+ * Sparse 2D grid for robot coordinates, shared by the painting robot (Day 11),
+ * the arcade tiles (Day 13) and the maze search (Day 15).
+ *
+ * The plane is split into fixed-size dense chunks of (1 << ChunkBits) squared
+ * cells. Chunks are found through a flat open-addressing table keyed by the
+ * packed chunk coordinates, with the last chunk used cached in front of it, so
+ * a robot taking single steps almost never probes the table at all.
+ *
+ * Each chunk keeps one bitmask word per row to tell set cells from cells that
+ * were never touched, and the grid tracks the bounding box of set cells.
+ */
+
+#ifndef SPARSE_GRID_H
+#define SPARSE_GRID_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+template <typename T, int ChunkBits = 6>
+class SparseGrid {
+public:
+    static_assert (ChunkBits >= 1 && ChunkBits <= 6,
+                   "chunk rows must fit in one 64-bit mask word");
+    static const int chunkSize = 1 << ChunkBits;
+
+    SparseGrid () {
+        clear ();
+    }
+
+    /*
+     * Reference to the cell at (x, y), default constructed and marked as set
+     * if it was never touched, like operator[] on a map
+     */
+    T &at (int x, int y) {
+        Chunk *chunk = findChunk (x >> ChunkBits, y >> ChunkBits, true);
+        int cx = x & (chunkSize - 1);
+        int cy = y & (chunkSize - 1);
+        uint64_t bit = uint64_t (1) << cx;
+        if (!(chunk->rowMask[cy] & bit)) {
+            chunk->rowMask[cy] |= bit;
+            numSet++;
+            // extend the bounding box of set cells
+            if (numSet == 1) {
+                boundMinX = boundMaxX = x;
+                boundMinY = boundMaxY = y;
+            }
+            else {
+                boundMinX = x < boundMinX ? x : boundMinX;
+                boundMaxX = x > boundMaxX ? x : boundMaxX;
+                boundMinY = y < boundMinY ? y : boundMinY;
+                boundMaxY = y > boundMaxY ? y : boundMaxY;
+            }
+        }
+        return chunk->cells[cy * chunkSize + cx];
+    }
+
+    /*
+     * Pointer to the cell at (x, y) if it was set, otherwise nullptr
+     */
+    const T *find (int x, int y) const {
+        Chunk *chunk = findChunk (x >> ChunkBits, y >> ChunkBits, false);
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+        int cx = x & (chunkSize - 1);
+        int cy = y & (chunkSize - 1);
+        if (!(chunk->rowMask[cy] & (uint64_t (1) << cx))) {
+            return nullptr;
+        }
+        return &chunk->cells[cy * chunkSize + cx];
+    }
+
+    bool contains (int x, int y) const {
+        return find (x, y) != nullptr;
+    }
+
+    // number of set cells
+    size_t size () const {
+        return numSet;
+    }
+
+    // bounding box of set cells, inclusive; only meaningful when size () > 0
+    int minX () const { return boundMinX; }
+    int minY () const { return boundMinY; }
+    int maxX () const { return boundMaxX; }
+    int maxY () const { return boundMaxY; }
+
+    void clear () {
+        chunks.clear ();
+        table.assign (16, -1);
+        lastChunk = nullptr;
+        numSet = 0;
+        boundMinX = boundMinY = 0;
+        boundMaxX = boundMaxY = -1;
+    }
+
+    /*
+     * Visit the set cells of row y from left to right as fn (x, value),
+     * looking up each chunk along the row only once
+     */
+    template <typename Fn>
+    void forEachInRow (int y, Fn fn) const {
+        if (!numSet || y < boundMinY || y > boundMaxY) {
+            return;
+        }
+        int cy = y & (chunkSize - 1);
+        for (int chunkX = boundMinX >> ChunkBits;
+             chunkX <= boundMaxX >> ChunkBits; chunkX++) {
+            Chunk *chunk = findChunk (chunkX, y >> ChunkBits, false);
+            if (chunk == nullptr) {
+                continue;
+            }
+            uint64_t mask = chunk->rowMask[cy];
+            const T *row = &chunk->cells[cy * chunkSize];
+            // walk only the set bits of the row
+            while (mask) {
+                int cx = __builtin_ctzll (mask);
+                fn ((chunkX << ChunkBits) + cx, row[cx]);
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    /*
+     * Visit every set cell as fn (x, y, value), chunk by chunk in memory order
+     */
+    template <typename Fn>
+    void forEach (Fn fn) const {
+        for (const std::unique_ptr<Chunk> &chunk : chunks) {
+            for (int cy = 0; cy < chunkSize; cy++) {
+                uint64_t mask = chunk->rowMask[cy];
+                while (mask) {
+                    int cx = __builtin_ctzll (mask);
+                    fn ((chunk->chunkX << ChunkBits) + cx,
+                        (chunk->chunkY << ChunkBits) + cy,
+                        chunk->cells[cy * chunkSize + cx]);
+                    mask &= mask - 1;
+                }
+            }
+        }
+    }
+
+private:
+    /*
+     * Dense block of cells, row-major, with a set-cell mask word per row
+     */
+    struct Chunk {
+        int chunkX;
+        int chunkY;
+        uint64_t rowMask[chunkSize];
+        T cells[chunkSize * chunkSize];
+    };
+
+    // helper function to pack chunk coordinates into a single table key
+    static uint64_t packKey (int chunkX, int chunkY) {
+        return (uint64_t (uint32_t (chunkX)) << 32) | uint32_t (chunkY);
+    }
+
+    // helper function to mix the packed key into a table slot
+    size_t slotOf (uint64_t key) const {
+        key ^= key >> 29;
+        key *= 0x9E3779B97F4A7C15ull;
+        return (key >> 32) & (table.size () - 1);
+    }
+
+    // linear probe for the chunk, optionally allocating it when missing
+    Chunk *findChunk (int chunkX, int chunkY, bool create) const {
+        if (lastChunk != nullptr && lastChunk->chunkX == chunkX &&
+            lastChunk->chunkY == chunkY) {
+            return lastChunk;
+        }
+        uint64_t key = packKey (chunkX, chunkY);
+        size_t slot = slotOf (key);
+        while (table[slot] != -1) {
+            Chunk *chunk = chunks[table[slot]].get ();
+            if (packKey (chunk->chunkX, chunk->chunkY) == key) {
+                lastChunk = chunk;
+                return chunk;
+            }
+            slot = (slot + 1) & (table.size () - 1);
+        }
+        if (!create) {
+            return nullptr;
+        }
+        return const_cast<SparseGrid *> (this)->addChunk (chunkX, chunkY, slot);
+    }
+
+    // allocate a new empty chunk into the free slot found by the probe
+    Chunk *addChunk (int chunkX, int chunkY, size_t slot) {
+        chunks.emplace_back (new Chunk ());
+        Chunk *chunk = chunks.back ().get ();
+        chunk->chunkX = chunkX;
+        chunk->chunkY = chunkY;
+        table[slot] = chunks.size () - 1;
+        // keep the table at most half full, rehashing into double the slots
+        if (chunks.size () * 2 > table.size ()) {
+            table.assign (table.size () * 2, -1);
+            for (size_t i = 0; i < chunks.size (); i++) {
+                size_t newSlot = slotOf (packKey (chunks[i]->chunkX,
+                                                  chunks[i]->chunkY));
+                while (table[newSlot] != -1) {
+                    newSlot = (newSlot + 1) & (table.size () - 1);
+                }
+                table[newSlot] = i;
+            }
+        }
+        lastChunk = chunk;
+        return chunk;
+    }
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    // chunk index per slot, -1 for an empty slot; size is a power of two
+    std::vector<int> table;
+    mutable Chunk *lastChunk;
+    size_t numSet;
+    int boundMinX;
+    int boundMinY;
+    int boundMaxX;
+    int boundMaxY;
+};
+
+#endif
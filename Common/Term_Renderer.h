@@ -0,0 +1,282 @@
+/*
+ * Incremental terminal renderer for 2D grids of single-character glyphs, shared
+ * by the painting robot (Day 11) and the arcade screen (Day 13).
+ *
+ * The renderer keeps the frame currently shown on the terminal. Cells are set
+ * individually with any (x, y) coordinates; only cells whose glyph actually
+ * changed are redrawn, using relative ANSI cursor moves from the top-left of
+ * the frame. Each frame is built in one buffer and written with one syscall.
+ *
+ * The very first frame is printed as plain rows with no escape codes, so a
+ * one-shot print (or output redirected to a file) looks like a normal printout.
+ * If the bounding box grows after the first frame, the frame is redrawn whole.
+ */
+
+#ifndef TERM_RENDERER_H
+#define TERM_RENDERER_H
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+struct TermRenderer {
+    // glyph for cells that were never set
+    char background;
+    // storage box: cells kept for (capX, capY) up to capWidth x capHeight
+    int capX;
+    int capY;
+    int capWidth;
+    int capHeight;
+    // bounding box of the cells set so far, inclusive
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+    // glyphs on the terminal and glyphs for the frame being built
+    std::vector<char> shown;
+    std::vector<char> next;
+    // storage indices set since the last flush that may differ from shown
+    std::vector<int> dirty;
+    // box of the frame currently on the terminal, if any
+    bool drawn;
+    int drawnX;
+    int drawnY;
+    int drawnWidth;
+    int drawnHeight;
+    // cursor position relative to the top-left of the drawn frame
+    int cursorX;
+    int cursorY;
+    // output buffer, reused across frames
+    std::string buffer;
+};
+
+/*
+ * Reset the renderer to an empty grid, forgetting anything already drawn
+ */
+inline void initRenderer (TermRenderer &renderer, char background) {
+    renderer.background = background;
+    renderer.capX = 0;
+    renderer.capY = 0;
+    renderer.capWidth = 0;
+    renderer.capHeight = 0;
+    renderer.minX = 0;
+    renderer.minY = 0;
+    renderer.maxX = -1;
+    renderer.maxY = -1;
+    renderer.shown.clear ();
+    renderer.next.clear ();
+    renderer.dirty.clear ();
+    renderer.drawn = false;
+    renderer.drawnX = 0;
+    renderer.drawnY = 0;
+    renderer.drawnWidth = 0;
+    renderer.drawnHeight = 0;
+    renderer.cursorX = 0;
+    renderer.cursorY = 0;
+    renderer.buffer.clear ();
+}
+
+/*
+ * Grow the storage box to contain (x, y), doubling the covered span on the
+ * growing side so a robot walking outward only reallocates a few times
+ */
+inline void growRenderer (TermRenderer &renderer, int x, int y) {
+    int newX = renderer.capX;
+    int newY = renderer.capY;
+    int newWidth = renderer.capWidth;
+    int newHeight = renderer.capHeight;
+    if (!newWidth || !newHeight) {
+        newX = x;
+        newY = y;
+        newWidth = 1;
+        newHeight = 1;
+    }
+    while (x < newX) {
+        newX -= newWidth;
+        newWidth *= 2;
+    }
+    while (x >= newX + newWidth) {
+        newWidth *= 2;
+    }
+    while (y < newY) {
+        newY -= newHeight;
+        newHeight *= 2;
+    }
+    while (y >= newY + newHeight) {
+        newHeight *= 2;
+    }
+
+    // copy both frames into the new storage box at their shifted offset
+    std::vector<char> newShown (newWidth * newHeight, renderer.background);
+    std::vector<char> newNext (newWidth * newHeight, renderer.background);
+    for (int row = 0; row < renderer.capHeight; row++) {
+        int from = row * renderer.capWidth;
+        int to = (row + renderer.capY - newY) * newWidth +
+                 (renderer.capX - newX);
+        std::copy (renderer.shown.begin () + from,
+                   renderer.shown.begin () + from + renderer.capWidth,
+                   newShown.begin () + to);
+        std::copy (renderer.next.begin () + from,
+                   renderer.next.begin () + from + renderer.capWidth,
+                   newNext.begin () + to);
+    }
+    renderer.shown.swap (newShown);
+    renderer.next.swap (newNext);
+    renderer.capX = newX;
+    renderer.capY = newY;
+    renderer.capWidth = newWidth;
+    renderer.capHeight = newHeight;
+    // old indices are stale; the bounding box changed so the flush redraws all
+    renderer.dirty.clear ();
+}
+
+/*
+ * Set the glyph of a single cell for the next flush
+ */
+inline void setCell (TermRenderer &renderer, int x, int y, char glyph) {
+    if (x < renderer.capX || x >= renderer.capX + renderer.capWidth ||
+        y < renderer.capY || y >= renderer.capY + renderer.capHeight) {
+        growRenderer (renderer, x, y);
+    }
+    // extend the bounding box, which forces a full redraw if already drawn
+    if (renderer.maxX < renderer.minX) {
+        renderer.minX = renderer.maxX = x;
+        renderer.minY = renderer.maxY = y;
+    }
+    else {
+        renderer.minX = std::min (renderer.minX, x);
+        renderer.maxX = std::max (renderer.maxX, x);
+        renderer.minY = std::min (renderer.minY, y);
+        renderer.maxY = std::max (renderer.maxY, y);
+    }
+
+    int index = (y - renderer.capY) * renderer.capWidth + (x - renderer.capX);
+    char &cell = renderer.next[index];
+    if (cell == glyph) {
+        return;
+    }
+    // only queue a cell when it first goes out of sync with the terminal
+    if (cell == renderer.shown[index]) {
+        renderer.dirty.push_back (index);
+    }
+    cell = glyph;
+}
+
+/*
+ * Set a run of cells from a string, starting at (x, y) and moving right
+ */
+inline void setText (TermRenderer &renderer, int x, int y,
+                     const std::string &text) {
+    for (int i = 0; i < (int)text.size (); i++) {
+        setCell (renderer, x + i, y, text[i]);
+    }
+}
+
+// helper function to append a relative cursor move to the frame buffer
+inline void moveCursor (TermRenderer &renderer, int x, int y) {
+    char code[32];
+    if (y < renderer.cursorY) {
+        renderer.buffer.append (code, snprintf (code, sizeof (code), "\033[%dA",
+                                                renderer.cursorY - y));
+    }
+    else if (y > renderer.cursorY) {
+        renderer.buffer.append (code, snprintf (code, sizeof (code), "\033[%dB",
+                                                y - renderer.cursorY));
+    }
+    if (x < renderer.cursorX) {
+        renderer.buffer.append (code, snprintf (code, sizeof (code), "\033[%dD",
+                                                renderer.cursorX - x));
+    }
+    else if (x > renderer.cursorX) {
+        renderer.buffer.append (code, snprintf (code, sizeof (code), "\033[%dC",
+                                                x - renderer.cursorX));
+    }
+    renderer.cursorX = x;
+    renderer.cursorY = y;
+}
+
+// helper function to write the whole buffer, retrying on partial writes
+inline void writeBuffer (const std::string &buffer) {
+    // anything already queued in stdio must land before this frame
+    fflush (stdout);
+    size_t written = 0;
+    while (written < buffer.size ()) {
+        ssize_t result = write (STDOUT_FILENO, buffer.data () + written,
+                                buffer.size () - written);
+        if (result <= 0) {
+            break;
+        }
+        written += result;
+    }
+}
+
+/*
+ * Emit every change since the last flush as a single write. The cursor is
+ * left on the line below the frame, so regular output can follow it.
+ */
+inline void flushFrame (TermRenderer &renderer) {
+    if (renderer.maxX < renderer.minX) {
+        return;
+    }
+    renderer.buffer.clear ();
+    int width = renderer.maxX - renderer.minX + 1;
+    int height = renderer.maxY - renderer.minY + 1;
+
+    // bounding box changed since the last frame: redraw every row in place
+    if (!renderer.drawn || renderer.drawnX != renderer.minX ||
+        renderer.drawnY != renderer.minY || renderer.drawnWidth != width ||
+        renderer.drawnHeight != height) {
+        if (renderer.drawn) {
+            moveCursor (renderer, 0, 0);
+            renderer.buffer += '\r';
+        }
+        renderer.buffer.reserve (renderer.buffer.size () +
+                                 (width + 4) * height);
+        for (int y = renderer.minY; y <= renderer.maxY; y++) {
+            int start = (y - renderer.capY) * renderer.capWidth +
+                        (renderer.minX - renderer.capX);
+            renderer.buffer.append (&renderer.next[start], width);
+            std::copy (renderer.next.begin () + start,
+                       renderer.next.begin () + start + width,
+                       renderer.shown.begin () + start);
+            // clear any leftover of a previous, wider frame
+            if (renderer.drawn) {
+                renderer.buffer += "\033[K";
+            }
+            renderer.buffer += '\n';
+        }
+        renderer.drawn = true;
+        renderer.drawnX = renderer.minX;
+        renderer.drawnY = renderer.minY;
+        renderer.drawnWidth = width;
+        renderer.drawnHeight = height;
+    }
+    // same box: visit changed cells in row-major order, skipping no-ops
+    else {
+        if (renderer.dirty.empty ()) {
+            return;
+        }
+        std::sort (renderer.dirty.begin (), renderer.dirty.end ());
+        for (int index : renderer.dirty) {
+            if (renderer.next[index] == renderer.shown[index]) {
+                continue;
+            }
+            int x = index % renderer.capWidth + renderer.capX - renderer.minX;
+            int y = index / renderer.capWidth + renderer.capY - renderer.minY;
+            moveCursor (renderer, x, y);
+            renderer.buffer += renderer.next[index];
+            renderer.shown[index] = renderer.next[index];
+            renderer.cursorX++;
+        }
+        moveCursor (renderer, 0, height);
+        renderer.buffer += '\r';
+    }
+    renderer.dirty.clear ();
+    renderer.cursorX = 0;
+    renderer.cursorY = height;
+    writeBuffer (renderer.buffer);
+}
+
+#endif
@@ -0,0 +1,671 @@
+/*
+ * Crossings of axis-aligned wire paths (Day 3).
+ *
+ * A wire is stored as contiguous arrays rather than linked nodes: the x and y
+ * of every corner, starting at the origin, and the cumulative steps along the
+ * wire to each corner. Its segments are separated up front into horizontal
+ * and vertical ones, each kept as arrays of the fixed coordinate (y of a
+ * horizontal segment, x of a vertical one), the range of the other coordinate
+ * and the corner the segment starts at, sorted by the fixed coordinate. The
+ * steps to any point on a segment then take one lookup, and scans over the
+ * segments of a wire run over flat arrays.
+ *
+ * sweepCrossings reports every point where a horizontal segment of one wire
+ * crosses a vertical segment of the other with a sweep line over x: the
+ * horizontals of each wire are inserted at their left end and removed after
+ * their right end, and each vertical queries the other wire's active
+ * horizontals by y. Each wire keeps its own sweep events sorted by x, built
+ * once with its segments, so a sweep only merges the two event lists. This
+ * takes O((n + m) log (n + m) + k) for n and m segments and k crossings, where
+ * comparing every pair took O(n * m).
+ *
+ * Segments of the two wires lying along the same line meet at every point
+ * their ranges share. An overlap may be long, so rather than every point it
+ * is reported at its two ends and at its point closest to the origin: across
+ * an overlap the steps along each wire change linearly, so the fewest steps
+ * are at an end, and the smallest distance is at one of those three points.
+ * The origin itself does not count as a crossing, so an overlap through it
+ * is also reported at the points either side of it.
+ * Overlaps are found by merging the segments of both wires line by line, as
+ * they are already sorted by fixed coordinate.
+ *
+ * summarizeCrossings gives both Day 3 answers from one sweep: the crossing
+ * closest to the origin by Manhattan distance and the fewest combined steps.
+ * summarizeAllPairs does the same for every pair of N wires, with the pairs
+ * shared out between threads.
+ *
+ * WireIndex answers "which wires pass through (x, y), and at what step?" for
+ * many points. It is bulk loaded from all the wires once into a segment grid:
+ * every segment is listed under each bucket of 1 << WireIndex::bucketBits
+ * cells it covers along its row or column, in one array grouped by bucket,
+ * and a hash table maps a bucket to its run of that array. A point query
+ * probes one row bucket and one column bucket and range checks the segments
+ * listed there. A segment covering more than WireIndex::maxBuckets buckets
+ * is instead listed once, among the long segments of its row or column, so
+ * a wire with moves of a billion cells costs no more memory than any other;
+ * each query also range checks the long segments on its row and column.
+ *
+ * stepsTo answers "steps to point P along wire k" on its own: the segments on
+ * P's row and column are found by binary search in the sorted arrays, and the
+ * steps along each come from the prefix sums of its start corner.
+ */
+
+#ifndef WIRE_PATHS_H
+#define WIRE_PATHS_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Segments of one orientation, sorted by fixed coordinate
+ */
+struct SegmentArrays {
+    // y of a horizontal segment, x of a vertical one
+    std::vector<int> fixed;
+    // range of the other coordinate, low <= high
+    std::vector<int> low;
+    std::vector<int> high;
+    // index of the corner the segment starts at
+    std::vector<int> corner;
+
+    size_t size () const {
+        return fixed.size ();
+    }
+};
+
+/*
+ * Point of the sweep over x where a segment of a wire is handled. At the same
+ * x, horizontals are inserted, then verticals query, then horizontals are
+ * removed, so crossings at segment ends are found.
+ */
+struct SweepEvent {
+    enum Type { INSERT, QUERY, REMOVE };
+
+    int x;
+    int type;
+    // index into the horizontal or vertical segments, by type
+    int index;
+
+    bool operator < (const SweepEvent &other) const {
+        return x != other.x ? x < other.x : type < other.type;
+    }
+};
+
+struct Wire {
+    // corners in path order, starting at the origin
+    std::vector<int> x;
+    std::vector<int> y;
+    // steps along the wire to each corner
+    std::vector<long> steps;
+    SegmentArrays horizontal;
+    SegmentArrays vertical;
+    // sweep events of the segments, sorted
+    std::vector<SweepEvent> events;
+};
+
+// helper function to separate the segments of a wire by orientation, sort
+// each kind by fixed coordinate and sort their sweep events
+inline void indexSegments (Wire &wire) {
+    SegmentArrays *kinds[2] = {&wire.horizontal, &wire.vertical};
+    std::vector<int> order[2];
+    for (int c = 0; c + 1 < (int)wire.x.size (); c++) {
+        // a segment of length 0 is not stored
+        if (wire.y[c] == wire.y[c + 1] && wire.x[c] != wire.x[c + 1]) {
+            order[0].push_back (c);
+        }
+        else if (wire.x[c] == wire.x[c + 1] && wire.y[c] != wire.y[c + 1]) {
+            order[1].push_back (c);
+        }
+    }
+    for (int k = 0; k < 2; k++) {
+        // fixed coordinate and the moving one, by orientation
+        const std::vector<int> &fixed = k == 0 ? wire.y : wire.x;
+        const std::vector<int> &moving = k == 0 ? wire.x : wire.y;
+        std::stable_sort (order[k].begin (), order[k].end (),
+                          [&] (int a, int b) { return fixed[a] < fixed[b]; });
+        SegmentArrays &segments = *kinds[k];
+        size_t count = order[k].size ();
+        segments.fixed.resize (count);
+        segments.low.resize (count);
+        segments.high.resize (count);
+        segments.corner.assign (order[k].begin (), order[k].end ());
+        for (size_t i = 0; i < count; i++) {
+            int c = order[k][i];
+            segments.fixed[i] = fixed[c];
+            segments.low[i] = std::min (moving[c], moving[c + 1]);
+            segments.high[i] = std::max (moving[c], moving[c + 1]);
+        }
+    }
+
+    wire.events.clear ();
+    wire.events.reserve (2 * wire.horizontal.size () + wire.vertical.size ());
+    for (int i = 0; i < (int)wire.horizontal.size (); i++) {
+        wire.events.push_back ({wire.horizontal.low[i], SweepEvent::INSERT,
+                                i});
+        wire.events.push_back ({wire.horizontal.high[i], SweepEvent::REMOVE,
+                                i});
+    }
+    for (int i = 0; i < (int)wire.vertical.size (); i++) {
+        wire.events.push_back ({wire.vertical.fixed[i], SweepEvent::QUERY, i});
+    }
+    std::sort (wire.events.begin (), wire.events.end ());
+}
+
+/*
+ * Parse a path of comma separated moves such as "R8,U5,L5,D3" into wire.
+ * Returns false if a move has an invalid direction; that move is skipped.
+ */
+inline bool parseWire (const std::string &line, Wire &wire) {
+    wire = Wire ();
+    size_t moves = std::count (line.begin (), line.end (), ',') + 1;
+    wire.x.reserve (moves + 1);
+    wire.y.reserve (moves + 1);
+    wire.steps.reserve (moves + 1);
+    wire.x.push_back (0);
+    wire.y.push_back (0);
+    wire.steps.push_back (0);
+    bool valid = true;
+    size_t i = 0;
+    while (i < line.size ()) {
+        char direction = line[i++];
+        long magnitude = 0;
+        while (i < line.size () && line[i] >= '0' && line[i] <= '9') {
+            magnitude = magnitude * 10 + (line[i++] - '0');
+        }
+        // skip the comma, or any trailing whitespace
+        while (i < line.size () && (line[i] < 'A' || line[i] > 'Z')) {
+            i++;
+        }
+        // update x and y from directions: (U)p, (D)own, (L)eft, (R)ight
+        int dx = direction == 'R' ? 1 : direction == 'L' ? -1 : 0;
+        int dy = direction == 'U' ? 1 : direction == 'D' ? -1 : 0;
+        if (dx == 0 && dy == 0) {
+            valid = false;
+            continue;
+        }
+        wire.x.push_back (wire.x.back () + dx * magnitude);
+        wire.y.push_back (wire.y.back () + dy * magnitude);
+        wire.steps.push_back (wire.steps.back () + magnitude);
+    }
+    indexSegments (wire);
+    return valid;
+}
+
+// helper function to find the steps to (x, y) along the segment starting at
+// corner
+inline long stepsAlong (const Wire &wire, int corner, int x, int y) {
+    return wire.steps[corner] + std::abs ((long)x - wire.x[corner]) +
+           std::abs ((long)y - wire.y[corner]);
+}
+
+/*
+ * Fewest steps along wire to reach (x, y), -1 if the wire never passes it
+ */
+inline long stepsTo (const Wire &wire, int x, int y) {
+    long best = x == 0 && y == 0 ? 0 : -1;
+    const SegmentArrays *kinds[2] = {&wire.horizontal, &wire.vertical};
+    for (int k = 0; k < 2; k++) {
+        const SegmentArrays &segments = *kinds[k];
+        int fixed = k == 0 ? y : x;
+        int moving = k == 0 ? x : y;
+        // segments on the point's row or column
+        auto first = std::lower_bound (segments.fixed.begin (),
+                                       segments.fixed.end (), fixed);
+        for (size_t i = first - segments.fixed.begin ();
+             i < segments.size () && segments.fixed[i] == fixed; i++) {
+            if (segments.low[i] > moving || segments.high[i] < moving) {
+                continue;
+            }
+            long steps = stepsAlong (wire, segments.corner[i], x, y);
+            best = best < 0 ? steps : std::min (best, steps);
+        }
+    }
+    return best;
+}
+
+/*
+ * Point where the two wires cross, and the steps along each to reach it
+ */
+struct Crossing {
+    int x;
+    int y;
+    long steps1;
+    long steps2;
+};
+
+/*
+ * Both answers over all crossings other than the origin, -1 if there are none.
+ * numCrossings counts reports: a point where both wires turn can be reported
+ * more than once, and an overlap at up to five points.
+ */
+struct CrossingSummary {
+    long closestDistance;
+    long fewestSteps;
+    long numCrossings;
+};
+
+// helper function to report where segment index1 of wire1 and segment index2
+// of wire2, on the same line, overlap between low and high
+template <typename Visitor>
+void visitOverlap (const Wire &wire1, const Wire &wire2, int kind, int index1,
+                   int index2, int low, int high, Visitor &visit) {
+    const SegmentArrays &segments1 = kind == 0 ? wire1.horizontal :
+                                                 wire1.vertical;
+    const SegmentArrays &segments2 = kind == 0 ? wire2.horizontal :
+                                                 wire2.vertical;
+    int fixed = segments1.fixed[index1];
+    // the ends, the closest point and, on a line through the origin, its
+    // neighbours, each once
+    int candidates[5] = {low, high, std::min (std::max (0, low), high), -1, 1};
+    int numCandidates = fixed == 0 ? 5 : 3;
+    int points[5];
+    int numPoints = 0;
+    for (int c = 0; c < numCandidates; c++) {
+        if (candidates[c] >= low && candidates[c] <= high &&
+            std::find (points, points + numPoints, candidates[c]) ==
+            points + numPoints) {
+            points[numPoints++] = candidates[c];
+        }
+    }
+    for (int p = 0; p < numPoints; p++) {
+        Crossing crossing;
+        crossing.x = kind == 0 ? points[p] : fixed;
+        crossing.y = kind == 0 ? fixed : points[p];
+        crossing.steps1 = stepsAlong (wire1, segments1.corner[index1],
+                                      crossing.x, crossing.y);
+        crossing.steps2 = stepsAlong (wire2, segments2.corner[index2],
+                                      crossing.x, crossing.y);
+        visit (crossing);
+    }
+}
+
+// helper function to find the overlaps of collinear segments of two wires,
+// one line at a time, and report them with visitOverlap
+template <typename Visitor>
+void overlapCrossings (const Wire &wire1, const Wire &wire2, Visitor &visit) {
+    for (int kind = 0; kind < 2; kind++) {
+        const SegmentArrays *lines[2] = {
+            kind == 0 ? &wire1.horizontal : &wire1.vertical,
+            kind == 0 ? &wire2.horizontal : &wire2.vertical};
+        size_t next[2] = {0, 0};
+        while (next[0] < lines[0]->size () && next[1] < lines[1]->size ()) {
+            int fixed = lines[0]->fixed[next[0]];
+            if (fixed != lines[1]->fixed[next[1]]) {
+                next[fixed < lines[1]->fixed[next[1]] ? 0 : 1]++;
+                continue;
+            }
+            // segments of each wire on this line, as (low, index) by low
+            std::vector<std::pair<int, int>> onLine[2];
+            for (int w = 0; w < 2; w++) {
+                while (next[w] < lines[w]->size () &&
+                       lines[w]->fixed[next[w]] == fixed) {
+                    onLine[w].push_back ({lines[w]->low[next[w]],
+                                         (int)next[w]});
+                    next[w]++;
+                }
+                std::sort (onLine[w].begin (), onLine[w].end ());
+            }
+            // walk along the line by low end: each segment overlaps the
+            // other wire's earlier segments that have not ended before it
+            std::vector<int> open[2];
+            size_t taken[2] = {0, 0};
+            while (taken[0] < onLine[0].size () ||
+                   taken[1] < onLine[1].size ()) {
+                int w = taken[1] == onLine[1].size () ||
+                        (taken[0] < onLine[0].size () &&
+                         onLine[0][taken[0]] < onLine[1][taken[1]]) ? 0 : 1;
+                int index = onLine[w][taken[w]++].second;
+                int low = lines[w]->low[index];
+                int other = 1 - w;
+                size_t kept = 0;
+                for (int otherIndex : open[other]) {
+                    int high = std::min (lines[w]->high[index],
+                                         lines[other]->high[otherIndex]);
+                    if (lines[other]->high[otherIndex] < low) {
+                        continue;
+                    }
+                    open[other][kept++] = otherIndex;
+                    visitOverlap (wire1, wire2, kind,
+                                  w == 0 ? index : otherIndex,
+                                  w == 0 ? otherIndex : index, low, high,
+                                  visit);
+                }
+                open[other].resize (kept);
+                open[w].push_back (index);
+            }
+        }
+    }
+}
+
+/*
+ * Call visit (const Crossing &) for every crossing of wire1 with wire2:
+ * where a horizontal segment of one meets a vertical segment of the other,
+ * and at the ends and closest point of every overlap along a shared line
+ */
+template <typename Visitor>
+void sweepCrossings (const Wire &wire1, const Wire &wire2, Visitor visit) {
+    overlapCrossings (wire1, wire2, visit);
+    const Wire *wires[2] = {&wire1, &wire2};
+    // active horizontals of each wire, by y and then by index, which is the
+    // same order as the sorted arrays
+    std::set<std::pair<int, int>> active[2];
+    // merge the two sorted event lists
+    size_t next[2] = {0, 0};
+    while (next[0] < wire1.events.size () || next[1] < wire2.events.size ()) {
+        int w = next[1] == wire2.events.size () ||
+                (next[0] < wire1.events.size () &&
+                 !(wire2.events[next[1]] < wire1.events[next[0]])) ? 0 : 1;
+        const Wire &wire = *wires[w];
+        const SweepEvent &event = wire.events[next[w]++];
+        if (event.type != SweepEvent::QUERY) {
+            std::pair<int, int> key (wire.horizontal.fixed[event.index],
+                                     event.index);
+            if (event.type == SweepEvent::INSERT) {
+                active[w].insert (key);
+            }
+            else {
+                active[w].erase (key);
+            }
+            continue;
+        }
+        int x = event.x;
+        int low = wire.vertical.low[event.index];
+        int high = wire.vertical.high[event.index];
+        int verticalCorner = wire.vertical.corner[event.index];
+        int other = 1 - w;
+        const Wire &otherWire = *wires[other];
+        for (auto it = active[other].lower_bound ({low, 0});
+             it != active[other].end () && it->first <= high; ++it) {
+            int y = it->first;
+            long verticalSteps = stepsAlong (wire, verticalCorner, x, y);
+            long horizontalSteps = stepsAlong (
+                otherWire, otherWire.horizontal.corner[it->second], x, y);
+            Crossing crossing;
+            crossing.x = x;
+            crossing.y = y;
+            crossing.steps1 = w == 0 ? verticalSteps : horizontalSteps;
+            crossing.steps2 = w == 0 ? horizontalSteps : verticalSteps;
+            visit (crossing);
+        }
+    }
+}
+
+/*
+ * Closest crossing and fewest combined steps of two wires, in one sweep
+ */
+inline CrossingSummary summarizeCrossings (const Wire &wire1,
+                                           const Wire &wire2) {
+    CrossingSummary summary = {-1, -1, 0};
+    sweepCrossings (wire1, wire2, [&] (const Crossing &crossing) {
+        // both wires start at the origin, which does not count
+        if (crossing.x == 0 && crossing.y == 0) {
+            return;
+        }
+        long distance = std::abs ((long)crossing.x) +
+                        std::abs ((long)crossing.y);
+        long steps = crossing.steps1 + crossing.steps2;
+        if (summary.numCrossings++ == 0) {
+            summary.closestDistance = distance;
+            summary.fewestSteps = steps;
+            return;
+        }
+        summary.closestDistance = std::min (summary.closestDistance, distance);
+        summary.fewestSteps = std::min (summary.fewestSteps, steps);
+    });
+    return summary;
+}
+
+/*
+ * Crossings of one pair of wires, by index
+ */
+struct PairSummary {
+    int wire1;
+    int wire2;
+    CrossingSummary summary;
+};
+
+/*
+ * Summarize every pair of wires, i < j, with numThreads threads, one per core
+ * if 0. Pairs are returned in order: (0, 1), (0, 2), ..., (1, 2), ...
+ */
+inline std::vector<PairSummary> summarizeAllPairs (
+        const std::vector<Wire> &wires, unsigned numThreads = 0) {
+    std::vector<PairSummary> pairs;
+    for (int i = 0; i < (int)wires.size (); i++) {
+        for (int j = i + 1; j < (int)wires.size (); j++) {
+            pairs.push_back ({i, j, {-1, -1, 0}});
+        }
+    }
+    if (numThreads == 0) {
+        numThreads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+    numThreads = std::min<size_t> (numThreads, std::max<size_t> (
+        1, pairs.size ()));
+
+    // each thread takes the next pair until none are left
+    std::atomic<size_t> nextPair (0);
+    auto work = [&] () {
+        size_t p;
+        while ((p = nextPair.fetch_add (1)) < pairs.size ()) {
+            pairs[p].summary = summarizeCrossings (wires[pairs[p].wire1],
+                                                   wires[pairs[p].wire2]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; t++) {
+        threads.emplace_back (work);
+    }
+    work ();
+    for (std::thread &thread : threads) {
+        thread.join ();
+    }
+    return pairs;
+}
+
+/*
+ * Wire passing through a queried point, with the fewest steps along it
+ */
+struct WireHit {
+    int wire;
+    long steps;
+};
+
+class WireIndex {
+public:
+    static const int bucketBits = 6;
+    // longest run of buckets a segment is listed under
+    static const int maxBuckets = 16;
+
+    /*
+     * Bulk load every segment of wires. The wires must outlive the index.
+     */
+    explicit WireIndex (const std::vector<Wire> &wires) : wires (&wires) {
+        // (key, segment) entries of both orientations, grouped by key
+        std::vector<std::pair<uint64_t, IndexedSegment>> entries;
+        for (int w = 0; w < (int)wires.size (); w++) {
+            const SegmentArrays *kinds[2] = {&wires[w].horizontal,
+                                             &wires[w].vertical};
+            for (int k = 0; k < 2; k++) {
+                const SegmentArrays &segments = *kinds[k];
+                for (size_t i = 0; i < segments.size (); i++) {
+                    IndexedSegment segment = {segments.low[i],
+                                              segments.high[i], w,
+                                              segments.corner[i]};
+                    if ((segments.high[i] >> bucketBits) -
+                        (segments.low[i] >> bucketBits) >= maxBuckets) {
+                        longSegments.push_back ({packKey (k, segments.fixed[i],
+                                                          0), segment});
+                        continue;
+                    }
+                    for (int bucket = segments.low[i] >> bucketBits;
+                         bucket <= segments.high[i] >> bucketBits; bucket++) {
+                        entries.push_back ({packKey (k, segments.fixed[i],
+                                                     bucket), segment});
+                    }
+                }
+            }
+        }
+        std::sort (entries.begin (), entries.end (), byKey);
+        std::sort (longSegments.begin (), longSegments.end (), byKey);
+
+        // table at most half full
+        size_t numSlots = 16;
+        while (numSlots < 2 * entries.size ()) {
+            numSlots *= 2;
+        }
+        table.assign (numSlots, {0, 0, 0});
+        segments.reserve (entries.size ());
+        size_t lastSlot = 0;
+        for (size_t i = 0; i < entries.size (); i++) {
+            if (i == 0 || entries[i].first != entries[i - 1].first) {
+                size_t slot = slotOf (entries[i].first);
+                while (table[slot].begin != table[slot].end) {
+                    slot = (slot + 1) & (table.size () - 1);
+                }
+                table[slot] = {entries[i].first, (uint32_t)i, (uint32_t)i};
+                lastSlot = slot;
+            }
+            segments.push_back (entries[i].second);
+            table[lastSlot].end++;
+        }
+    }
+
+    /*
+     * Append a hit for every wire through (x, y) to hits, one per wire with
+     * its fewest steps to the point. Returns the number appended.
+     */
+    size_t query (int x, int y, std::vector<WireHit> &hits) const {
+        size_t first = hits.size ();
+        if (x == 0 && y == 0) {
+            // every wire starts at the origin
+            for (int w = 0; w < (int)wires->size (); w++) {
+                hits.push_back ({w, 0});
+            }
+            return wires->size ();
+        }
+        for (int k = 0; k < 2; k++) {
+            int fixed = k == 0 ? y : x;
+            int moving = k == 0 ? x : y;
+            const Slot *slot = findSlot (packKey (k, fixed,
+                                                  moving >> bucketBits));
+            if (slot != nullptr) {
+                for (uint32_t i = slot->begin; i < slot->end; i++) {
+                    addSegmentHit (segments[i], x, y, moving, hits, first);
+                }
+            }
+            // long segments on the same row or column
+            std::pair<uint64_t, IndexedSegment> line {packKey (k, fixed, 0),
+                                                      {}};
+            for (auto it = std::lower_bound (longSegments.begin (),
+                                             longSegments.end (), line, byKey);
+                 it != longSegments.end () && it->first == line.first; ++it) {
+                addSegmentHit (it->second, x, y, moving, hits, first);
+            }
+        }
+        return hits.size () - first;
+    }
+
+    /*
+     * Query a batch of points. The hits of points[i] are
+     * hits[offsets[i], offsets[i + 1]).
+     */
+    void query (const std::vector<std::pair<int, int>> &points,
+                std::vector<WireHit> &hits,
+                std::vector<size_t> &offsets) const {
+        hits.clear ();
+        offsets.assign (1, 0);
+        offsets.reserve (points.size () + 1);
+        for (const std::pair<int, int> &point : points) {
+            query (point.first, point.second, hits);
+            offsets.push_back (hits.size ());
+        }
+    }
+
+private:
+    /*
+     * Segment listed under a bucket, with the wire and corner it starts at
+     */
+    struct IndexedSegment {
+        int low;
+        int high;
+        int wire;
+        int corner;
+    };
+
+    // run of segments of one bucket, empty when unused
+    struct Slot {
+        uint64_t key;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // helper function to pack orientation, row or column, and bucket along it
+    static uint64_t packKey (int kind, int fixed, int bucket) {
+        return (uint64_t (uint32_t (fixed)) << 32) |
+               (uint32_t (bucket) & 0x7FFFFFFF) |
+               (uint64_t (kind) << 31);
+    }
+
+    // helper function to mix the packed key into a table slot
+    size_t slotOf (uint64_t key) const {
+        key ^= key >> 29;
+        key *= 0x9E3779B97F4A7C15ull;
+        return (key >> 32) & (table.size () - 1);
+    }
+
+    // linear probe for the bucket's slot
+    const Slot *findSlot (uint64_t key) const {
+        size_t slot = slotOf (key);
+        while (table[slot].begin != table[slot].end) {
+            if (table[slot].key == key) {
+                return &table[slot];
+            }
+            slot = (slot + 1) & (table.size () - 1);
+        }
+        return nullptr;
+    }
+
+    // helper function to order (key, segment) entries by key
+    static bool byKey (const std::pair<uint64_t, IndexedSegment> &a,
+                       const std::pair<uint64_t, IndexedSegment> &b) {
+        return a.first < b.first;
+    }
+
+    // helper function to record a hit if the segment covers the point
+    void addSegmentHit (const IndexedSegment &segment, int x, int y,
+                        int moving, std::vector<WireHit> &hits,
+                        size_t first) const {
+        if (segment.low > moving || segment.high < moving) {
+            return;
+        }
+        addHit (hits, first, segment.wire,
+                stepsAlong ((*wires)[segment.wire], segment.corner, x, y));
+    }
+
+    // helper function to record a wire's steps, keeping its fewest
+    static void addHit (std::vector<WireHit> &hits, size_t first, int wire,
+                        long steps) {
+        for (size_t i = first; i < hits.size (); i++) {
+            if (hits[i].wire == wire) {
+                hits[i].steps = std::min (hits[i].steps, steps);
+                return;
+            }
+        }
+        hits.push_back ({wire, steps});
+    }
+
+    const std::vector<Wire> *wires;
+    std::vector<IndexedSegment> segments;
+    std::vector<Slot> table;
+    // (row or column key, segment) of the long segments, sorted by key
+    std::vector<std::pair<uint64_t, IndexedSegment>> longSegments;
+};
+
+#endif
\ No newline at end of file
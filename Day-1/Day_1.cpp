@@ -1,46 +1,160 @@
 /*
  * Day 1, 2019: Calculate total fuel costs given an input of masses:
  *   cost = mass / 3 - 2
+ *
+ * both parts are computed in a single pass over the input, split into chunks
+ * that are parsed and reduced on separate threads (Common/Line_Reducer.h).
+ * masses are parsed in blocks and each block runs through a kernel,
+ * vectorized with AVX2 when the processor supports it: eight masses per
+ * vector, with lanes masked out of the fuel-of-fuel loop as they reach zero.
+ * totals are 64-bit, so manifests of hundreds of millions of masses do not
+ * overflow.
  */
 
 #include <iostream>
-#include <fstream>
+#include <climits>
+#include <immintrin.h>
 
-int main () {
-    std::ifstream inFile ("input.txt");
-    std::string line;
+#include "../Common/Line_Reducer.h"
 
-    /* Part 1: -------------------------------------------------------------- */
+/*
+ * running totals for both parts, reducing the masses of one chunk
+ */
+struct FuelTotals {
+    long part1 = 0;
+    long part2 = 0;
+
+    void add (const long *masses, size_t count);
+    void merge (const FuelTotals &other);
+};
 
-    int total = 0;
-    while (std::getline (inFile, line)) {
-        // parse mass value and add to total
-        int mass = std::stoi(line);
-        total += mass / 3 - 2;
+/*
+ * add the fuel costs of a single mass to the totals
+ */
+void addFuel (long mass, FuelTotals &totals);
+
+/*
+ * add the fuel costs of a block of masses, each in [0, INT_MAX], choosing the
+ * AVX2 kernel when available
+ */
+void addFuelBlock (const int *masses, size_t count, FuelTotals &totals);
+
+int main () {
+    FuelTotals totals;
+    if (!reduceFile ("input.txt", totals)) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
 
-    printf ("Part 1 solution: %d\n", total);
+    /* Part 1: -------------------------------------------------------------- */
+
+    printf ("Part 1 solution: %ld\n", totals.part1);
 
     /* Part 2: -------------------------------------------------------------- */
 
-    // reset file and totals
-    inFile.clear ();
-    inFile.seekg (0, std::ios::beg);
-    total = 0;
+    printf ("Part 2 solution: %ld\n", totals.part2);
 
-    while (std::getline (inFile, line)) {
-        // parse mass value and calculate fuel mass for total
-        int mass = std::stoi(line);
-        int fuel = mass / 3 - 2;
-        total += fuel;
+    return 0;
+}
 
-        // calculate fuel cost for this fuel mass, add to total
-        while ((fuel = fuel / 3 - 2) > 0) {
-            total += fuel;
+void FuelTotals::add (const long *masses, size_t count) {
+    // masses outside the kernel's range are handled one by one
+    int block [blockValues];
+    size_t blockSize = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (masses[i] >= 0 && masses[i] <= INT_MAX) {
+            block[blockSize++] = masses[i];
+        }
+        else {
+            addFuel (masses[i], *this);
         }
     }
+    addFuelBlock (block, blockSize, *this);
+}
 
-    printf ("Part 2 solution: %d\n", total);
+void FuelTotals::merge (const FuelTotals &other) {
+    part1 += other.part1;
+    part2 += other.part2;
+}
 
-    return 0;
+void addFuel (long mass, FuelTotals &totals) {
+    // part 1 counts the fuel for the mass alone
+    long fuel = mass / 3 - 2;
+    totals.part1 += fuel;
+    totals.part2 += fuel;
+
+    // part 2: calculate fuel cost for this fuel mass, add to total
+    while ((fuel = fuel / 3 - 2) > 0) {
+        totals.part2 += fuel;
+    }
+}
+
+// helper function to divide eight unsigned 32-bit lanes by 3: the high half
+// of x * 0xAAAAAAAB, shifted right once more, is x / 3 for any 32-bit x
+__attribute__ ((target ("avx2")))
+static inline __m256i divideBy3 (__m256i x) {
+    const __m256i magic = _mm256_set1_epi64x (0xAAAAAAAB);
+    // _mm256_mul_epu32 multiplies the even lanes; shift the odd lanes down
+    __m256i even = _mm256_srli_epi64 (_mm256_mul_epu32 (x, magic), 33);
+    __m256i odd = _mm256_srli_epi64 (
+        _mm256_mul_epu32 (_mm256_srli_epi64 (x, 32), magic), 33);
+    return _mm256_blend_epi32 (even, _mm256_slli_epi64 (odd, 32), 0xAA);
+}
+
+// helper function to add eight signed 32-bit lanes into four 64-bit sums
+__attribute__ ((target ("avx2")))
+static inline __m256i addWidened (__m256i sums, __m256i x) {
+    sums = _mm256_add_epi64 (sums, _mm256_cvtepi32_epi64 (
+        _mm256_castsi256_si128 (x)));
+    return _mm256_add_epi64 (sums, _mm256_cvtepi32_epi64 (
+        _mm256_extracti128_si256 (x, 1)));
+}
+
+// helper function to sum the four 64-bit lanes
+__attribute__ ((target ("avx2")))
+static inline long horizontalSum (__m256i sums) {
+    long lanes [4];
+    _mm256_storeu_si256 ((__m256i *)lanes, sums);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__ ((target ("avx2")))
+static void addFuelBlockAvx2 (const int *masses, size_t count,
+                              FuelTotals &totals) {
+    const __m256i two = _mm256_set1_epi32 (2);
+    const __m256i zero = _mm256_setzero_si256 ();
+    __m256i sums1 = zero;
+    __m256i sums2 = zero;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i mass = _mm256_loadu_si256 ((const __m256i *)(masses + i));
+        // part 1 fuel, negative for masses below 6, counts in both parts
+        __m256i fuel = _mm256_sub_epi32 (divideBy3 (mass), two);
+        sums1 = addWidened (sums1, fuel);
+        sums2 = addWidened (sums2, fuel);
+        // fuel of fuel: lanes clamp to zero once done, and stay there
+        fuel = _mm256_max_epi32 (fuel, zero);
+        while (!_mm256_testz_si256 (fuel, fuel)) {
+            fuel = _mm256_max_epi32 (
+                _mm256_sub_epi32 (divideBy3 (fuel), two), zero);
+            sums2 = addWidened (sums2, fuel);
+        }
+    }
+    totals.part1 += horizontalSum (sums1);
+    totals.part2 += horizontalSum (sums2);
+    // remainder of the block
+    for (; i < count; i++) {
+        addFuel (masses[i], totals);
+    }
+}
+
+void addFuelBlock (const int *masses, size_t count, FuelTotals &totals) {
+    static const bool avx2 = __builtin_cpu_supports ("avx2");
+    if (avx2) {
+        addFuelBlockAvx2 (masses, count, totals);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        addFuel (masses[i], totals);
+    }
 }
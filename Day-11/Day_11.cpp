@@ -11,7 +11,10 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
-#include <unordered_map>
+
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Sparse_Grid.h"
+#include "../Common/Term_Renderer.h"
 
 /*
  * process the inputs given by opcodes and entries within the input values
@@ -42,33 +45,29 @@ int runOpcode (std::vector<long> &inputVals, int &index, long input,
                long &output, int &relativeBase);
 
 /*
- * Hash function for pair representing int coordinates to be painted
+ * Pair representing int coordinates to be painted, stored in a chunked grid
  */
 typedef std::pair<int, int> coord;
 
-class pairHash {
-public:
-    size_t operator () (const std::pair<int, int> &toHash) const {
-        return toHash.first * 100 + toHash.second;
-    }
-};
-
 /*
  * Run the painter robot from the input of opcode instructions
+ *
+ * If renderEvery is nonzero, the hull is drawn live once every renderEvery
+ * moves, redrawing only the panels painted since the last frame.
  */
-void runPainter (std::unordered_map<coord, int, pairHash> &paintMap,
-                 std::vector<long> &inputVals, int startColor);
+void runPainter (SparseGrid<int> &paintMap,
+                 std::vector<long> &inputVals, int startColor,
+                 int renderEvery);
 
-void printPainter (std::unordered_map<coord, int, pairHash> &paintMap);
+void printPainter (SparseGrid<int> &paintMap);
 
-int main () {
-    std::ifstream inFile ("input.txt");
+int main (int argc, char *argv[]) {
     // add each input value to vector for indexed read/write operations
     std::vector<long> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stol (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
     // obtain deep copy of this original vector for part 2:
     std::vector<long> inputOriginal;
@@ -77,25 +76,34 @@ int main () {
     /* Part 1: -------------------------------------------------------------- */
 
     // track painted coordinates: start at (0, 0), val 0->black, val 1->white
-    std::unordered_map<coord, int, pairHash> paintMap;
-        runPainter (paintMap, inputVals, 0);
+    SparseGrid<int> paintMap;
+    runPainter (paintMap, inputVals, 0, 0);
 
     // number of painted squares stored in paintMap
-    printf("Part 1 Solution: %d\n", paintMap.size ());
+    printf("Part 1 Solution: %zu\n", paintMap.size ());
 
     /* Part 2: -------------------------------------------------------------- */
 
     paintMap.clear();
     inputVals.assign (inputOriginal.begin (), inputOriginal.end ());
 
+    // optional first argument: draw the hull live, one of every N moves
+    int renderEvery = argc > 1 ? std::stoi (argv[1]) : 0;
+
     // color should have started on a single white square
-    runPainter (paintMap, inputVals, 1);
+    runPainter (paintMap, inputVals, 1, renderEvery);
     printf("Part 2 Solution:\n");
     printPainter (paintMap);
 }
 
-void runPainter (std::unordered_map<coord, int, pairHash> &paintMap,
-                 std::vector<long> &inputVals, int startColor) {
+void runPainter (SparseGrid<int> &paintMap,
+                 std::vector<long> &inputVals, int startColor,
+                 int renderEvery) {
+    // live view of the hull: x is mirrored to match printPainter
+    TermRenderer renderer;
+    initRenderer (renderer, '.');
+    int moves = 0;
+
     // current position at origin, facing up
     coord currPos ({0, 0});
     int currDir = 0;
@@ -103,29 +111,27 @@ void runPainter (std::unordered_map<coord, int, pairHash> &paintMap,
     coord directions[] = {{0, -1}, {-1, 0}, {0, 1}, {1, 0}};
 
     // part 2: should have started at white square
-    paintMap.insert ({currPos, startColor});
+    paintMap.at (currPos.first, currPos.second) = startColor;
 
     int index = 0;
     int base = 0;
     while (index < inputVals.size ()) {
         // get the color of the current position, default painted black
         int colorInput = 0;
-        std::unordered_map<coord, int, pairHash>::iterator search;
-        search = paintMap.find (currPos);
+        const int *search = paintMap.find (currPos.first, currPos.second);
         // location already painted, get color as input
-        if (search != paintMap.end ()) {
-
-            colorInput = search->second;
-            //            printf ("found color: %d\n", colorInput);
+        if (search != nullptr) {
+            colorInput = *search;
         }
         int colorOutput = processInput (inputVals, colorInput, index, base);
-        // location already in painted map, update color
-        if (search != paintMap.end ()) {
-            search->second = colorOutput;
-        }
-        // otherwise need to add location to map with painted color
-        else {
-            paintMap.insert ({currPos, colorOutput});
+        // update color, adding the location to the map if not yet painted
+        paintMap.at (currPos.first, currPos.second) = colorOutput;
+        if (renderEvery) {
+            setCell (renderer, -currPos.first, currPos.second,
+                     colorOutput == 1 ? '#' : '.');
+            if (++moves % renderEvery == 0) {
+                flushFrame (renderer);
+            }
         }
 
         // get turn direction: 0 -> left, 1 -> right 90 degrees
@@ -141,46 +147,20 @@ void runPainter (std::unordered_map<coord, int, pairHash> &paintMap,
         currPos.first += directions[currDir].first;
         currPos.second += directions[currDir].second;
     }
-}
-
-void printPainter (std::unordered_map<coord, int, pairHash> &paintMap) {
-    // find top-left and bottom-right points to print
-    int minX = 99999;
-    int minY = 99999;
-    int maxX = -99999;
-    int maxY = -99999;
-    for (std::pair<coord, int> entry : paintMap) {
-        coord currPos = entry.first;
-        if (minX > currPos.first) {
-            minX = currPos.first;
-        }
-        if (minY > currPos.second) {
-            minY = currPos.second;
-        }
-        if (maxX < currPos.first) {
-            maxX = currPos.first;
-        }
-        if (maxY < currPos.second) {
-            maxY = currPos.second;
-        }
+    if (renderEvery) {
+        flushFrame (renderer);
     }
+}
 
-    // starting at top-left point, print the map
-    for (int y = minY; y <= maxY; y++) {
-        for (int x = maxX; x >= minX; x--) {
-            std::unordered_map<coord, int, pairHash>::iterator search;
-            coord currPos = {x, y};
-            search = paintMap.find (currPos);
-            // point found, check if painted white
-            if (search != paintMap.end () && search->second == 1) {
-                std::cout << "#";
-            }
-            else {
-                std::cout << ".";
-            }
-        }
-        std::cout << "\n";
-    }
+void printPainter (SparseGrid<int> &paintMap) {
+    // one pass over the painted squares; the renderer tracks the bounds and
+    // prints the whole frame at once. x is mirrored: print from maxX to minX
+    TermRenderer renderer;
+    initRenderer (renderer, '.');
+    paintMap.forEach ([&renderer] (int x, int y, int color) {
+        setCell (renderer, -x, y, color == 1 ? '#' : '.');
+    });
+    flushFrame (renderer);
 }
 
 int processInput (std::vector<long> &inputVals, long input, int &index,
@@ -1,12 +1,17 @@
 /*
- * Day 11: Use programs from Day 9 and 11 to set up the tiles for a game in 2D
- * space.
+ * Day 13: Use programs from Day 9 and 11 to set up the tiles for a game in 2D
+ * space, then play the game to the end with a paddle that follows the ball.
  */
 
 #include <iostream>
 #include <fstream>
 #include <vector>
-#include <unordered_map>
+#include <string>
+#include <algorithm>
+
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Sparse_Grid.h"
+#include "../Common/Term_Renderer.h"
 
 /*
  * process the inputs given by opcodes and entries within the input values
@@ -14,8 +19,6 @@
  *
  * need to pass index and relativeBase as references to store outside of caller
  * function in order to handle start/stop at each output
- *
- * Part 2 cheating: if flag set to cheat, then in
  */
 int processInput (std::vector<long> &inputVals, long input, int &index,
                   int &relativeBase);
@@ -39,94 +42,176 @@ int runOpcode (std::vector<long> &inputVals, int &index, long input,
                long &output, int &relativeBase);
 
 /*
- * Hash function for pair representing int coordinates for each tile
+ * Set up the tiles of the game from the input
  */
-typedef std::pair<int, int> coord;
+void setupTiles (SparseGrid<int> &tileMap,
+                 std::vector<long> &inputVals);
 
-class pairHash {
-public:
-    size_t operator () (const std::pair<int, int> &toHash) const {
-        return toHash.first * 100 + toHash.second;
-    }
+void printTiles (SparseGrid<int> &tileMap);
+
+/*
+ * Headless arcade cabinet: the screen is a dense framebuffer of tile IDs that
+ * grows to fit whatever the game draws, indexed by y * width + x. The ball and
+ * paddle positions and the score are updated as each output triple is drawn,
+ * so the joystick never has to search the screen.
+ *
+ * When rendering, every drawn tile is also forwarded to the terminal renderer,
+ * which only redraws the cells that changed since the last rendered frame.
+ */
+struct Arcade {
+    std::vector<unsigned char> screen;
+    int width;
+    int height;
+    int ballX;
+    int paddleX;
+    int score;
+    // number of joystick reads so far, one per game frame
+    int frames;
+    // render one of every renderEvery frames, 0 for headless
+    int renderEvery;
+    TermRenderer renderer;
 };
 
 /*
- * Set up the tiles of the game from the input
+ * Draw a single tile into the framebuffer, or update the score for (-1, 0)
  */
-void setupTiles (std::unordered_map<coord, int, pairHash> &tileMap,
-                 std::vector<long> &inputVals);
+void drawTile (Arcade &arcade, int x, int y, int type);
 
-void printTiles (std::unordered_map<coord, int, pairHash> &tileMap);
+/*
+ * Print the changes to the screen since the last render as a single write
+ */
+void renderArcade (Arcade &arcade);
 
 /*
  * Beat the game by breaking all the blocks and determine the final score.
  *
- * Precondition: Cheat by modifying the input to put the paddle over the entire
- * screen!
+ * The built-in paddle AI moves the joystick toward the ball on every frame.
+ * If renderEvery is nonzero, the screen is printed once every renderEvery
+ * frames; otherwise the game runs headless at full speed.
  */
-int winGame (std::vector<long> &inputVals);
+int winGame (std::vector<long> &inputVals, int renderEvery);
 
-int main () {
-    std::ifstream inFile ("input.txt");
+int main (int argc, char *argv[]) {
     // add each input value to vector for indexed read/write operations
     std::vector<long> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stol (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
+    // obtain deep copy of this original vector for part 2:
+    std::vector<long> inputOriginal;
+    inputOriginal.assign (inputVals.begin (), inputVals.end ());
 
     /* Part 1: -------------------------------------------------------------- */
 
     // track tile coordinates: positive int value denotes the tile ID
-    std::unordered_map<coord, int, pairHash> tileMap;
+    SparseGrid<int> tileMap;
     setupTiles (tileMap, inputVals);
 
     // count number of "ID 2" tiles
     int numBlocks = 0;
-    for (std::pair<coord, int> entry : tileMap) {
-        if (entry.second == 2) {
+    tileMap.forEach ([&numBlocks] (int x, int y, int type) {
+        if (type == 2) {
             numBlocks ++;
         }
-    }
+    });
     // number of painted squares stored in paintMap
     printf ("Part 1 Solution: %d\n", numBlocks);
 
     /* Part 2: -------------------------------------------------------------- */
 
-    // use cheated input! this is why obfuscating machine code is important.
-    std::ifstream cheatFile ("inputCheat.txt");
-    std::vector<long> inputCheat;
-    while (std::getline (cheatFile, val, ',')) {
-        inputCheat.push_back (std::stol (val));
-    }
-    tileMap.clear ();
+    // optional first argument: render one of every N frames while playing
+    int renderEvery = argc > 1 ? std::stoi (argv[1]) : 0;
 
-    // now win the game.
-    inputCheat.at (0) = 2;
-    int finalScore = winGame (inputCheat);
+    // insert quarters into the original program and let the paddle AI play
+    inputOriginal.at (0) = 2;
+    int finalScore = winGame (inputOriginal, renderEvery);
     printf ("Part 2 Solution: %d\n", finalScore);
 
 }
 
-int winGame (std::vector<long> &inputVals) {
-    // run game normally: every 3 outputs: x, y, then tile type
+int winGame (std::vector<long> &inputVals, int renderEvery) {
+    Arcade arcade {{}, 0, 0, 0, 0, 0, 0, renderEvery, {}};
+    initRenderer (arcade.renderer, ' ');
+    // drive the opcodes directly, collecting every 3 outputs: x, y, tile type
     int index = 0;
     int relativeBase = 0;
-    int lastScore = 0;
+    long triple[3];
+    int numOutputs = 0;
     while (index < inputVals.size ()) {
-        int x = processInput (inputVals, 0, index, relativeBase);
-        int y = processInput (inputVals, 0, index, relativeBase);
-        int type = processInput (inputVals, 0, index, relativeBase);
-        // check for score update
-        if (x == -1 && !y) {
-            lastScore = type;
+        // input opcode marks a new frame: game is waiting on the joystick
+        if (inputVals.at (index) % 100 == 3) {
+            arcade.frames++;
+            if (renderEvery && arcade.frames % renderEvery == 0) {
+                renderArcade (arcade);
+            }
+        }
+        // tilt the joystick toward the ball: -1 left, 0 neutral, 1 right
+        long joystick = (arcade.ballX > arcade.paddleX) -
+                        (arcade.ballX < arcade.paddleX);
+        long output = -99999;
+        index += runOpcode (inputVals, index, joystick, output, relativeBase);
+        if (output != -99999) {
+            triple[numOutputs++] = output;
+            if (numOutputs == 3) {
+                drawTile (arcade, triple[0], triple[1], triple[2]);
+                numOutputs = 0;
+            }
         }
     }
-    return lastScore;
+    if (renderEvery) {
+        renderArcade (arcade);
+    }
+    return arcade.score;
 }
 
-void setupTiles (std::unordered_map<coord, int, pairHash> &tileMap,
+void drawTile (Arcade &arcade, int x, int y, int type) {
+    // score update replaces the tile draw at this position
+    if (x == -1 && !y) {
+        arcade.score = type;
+        return;
+    }
+    // nothing is drawn at negative coordinates
+    if (x < 0 || y < 0) {
+        return;
+    }
+    // grow the framebuffer when drawing outside of it, usually only once
+    if (x >= arcade.width || y >= arcade.height) {
+        int newWidth = std::max (arcade.width, x + 1);
+        int newHeight = std::max (arcade.height, y + 1);
+        std::vector<unsigned char> newScreen (newWidth * newHeight, 0);
+        for (int row = 0; row < arcade.height; row++) {
+            std::copy (arcade.screen.begin () + row * arcade.width,
+                       arcade.screen.begin () + (row + 1) * arcade.width,
+                       newScreen.begin () + row * newWidth);
+        }
+        arcade.screen.swap (newScreen);
+        arcade.width = newWidth;
+        arcade.height = newHeight;
+    }
+    arcade.screen[y * arcade.width + x] = type;
+    if (arcade.renderEvery) {
+        // same glyphs as printTiles, indexed by tile ID; row 0 holds the score
+        const char glyphs[] = {'.', '#', 'B', 'T', 'O'};
+        setCell (arcade.renderer, x, y + 1, type >= 0 && type < 5 ?
+                 glyphs[type] : '?');
+    }
+    // track the two moving pieces as they are drawn
+    if (type == 3) {
+        arcade.paddleX = x;
+    }
+    else if (type == 4) {
+        arcade.ballX = x;
+    }
+}
+
+void renderArcade (Arcade &arcade) {
+    setText (arcade.renderer, 0, 0, "Score: " + std::to_string (arcade.score));
+    flushFrame (arcade.renderer);
+}
+
+void setupTiles (SparseGrid<int> &tileMap,
                  std::vector<long> &inputVals) {
     // every 3 outputs: x, y, then tile type
     int index = 0;
@@ -137,64 +222,20 @@ void setupTiles (std::unordered_map<coord, int, pairHash> &tileMap,
         int type = processInput (inputVals, 0, index, relativeBase);
         // catch output exception when reading halt opcode
         if (x != -99999) {
-            tileMap.insert ({{x, y}, type});
+            tileMap.at (x, y) = type;
         }
     }
 }
 
-void printTiles (std::unordered_map<coord, int, pairHash> &tileMap) {
-    // find top-left and bottom-right points to print
-    int minX = 99999;
-    int minY = 99999;
-    int maxX = -99999;
-    int maxY = -99999;
-    for (std::pair<coord, int> entry : tileMap) {
-        coord currPos = entry.first;
-        if (minX > currPos.first) {
-            minX = currPos.first;
-        }
-        if (minY > currPos.second) {
-            minY = currPos.second;
-        }
-        if (maxX < currPos.first) {
-            maxX = currPos.first;
-        }
-        if (maxY < currPos.second) {
-            maxY = currPos.second;
-        }
-    }
-
-    // starting at top-left point, print the map
-    for (int y = minY; y <= maxY; y++) {
-        for (int x = maxX; x >= minX; x--) {
-            std::unordered_map<coord, int, pairHash>::iterator search;
-            coord currPos = {x, y};
-            search = tileMap.find (currPos);
-            if (search != tileMap.end ()) {
-                // wall tile
-                if (search->second == 1) {
-                    std::cout << "#";
-                }
-                // block tile
-                else if (search->second == 2) {
-                    std::cout << "B";
-                }
-                // horizontal paddle tile
-                else if (search->second == 3) {
-                    std::cout << "T";
-                }
-                // ball tile
-                else if (search->second == 4) {
-                    std::cout << "O";
-                }
-                // empty tile
-                else {
-                    std::cout << ".";
-                }
-            }
-        }
-        std::cout << "\n";
-    }
+void printTiles (SparseGrid<int> &tileMap) {
+    // one pass over the tiles; the renderer tracks the bounds and prints once
+    const char glyphs[] = {'.', '#', 'B', 'T', 'O'};
+    TermRenderer renderer;
+    initRenderer (renderer, ' ');
+    tileMap.forEach ([&] (int x, int y, int type) {
+        setCell (renderer, x, y, type >= 0 && type < 5 ? glyphs[type] : '.');
+    });
+    flushFrame (renderer);
 }
 
 
@@ -7,7 +7,9 @@
 #include <fstream>
 #include <vector>
 #include <deque>
-#include <unordered_map>
+
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Sparse_Grid.h"
 
 /*
  * process the inputs given by opcodes and entries within the input values
@@ -43,13 +45,12 @@ bool runMaze (std::vector<long> &inputVals, int& currSteps, int lastDir);
 int runDepth (std::vector<long> inputVals);
 
 int main () {
-    std::ifstream inFile ("input.txt");
     // add each input value to vector for indexed read/write operations
     std::vector<long> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stol (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
     // obtain deep copy of this original vector for part 2:
     std::vector<long> inputOriginal;
@@ -105,16 +106,6 @@ bool runMaze (std::vector<long> &inputVals, int& currSteps, int lastDir) {
 	return false;
 }
 
-/*
- * Function class for hash of pairs (x, y) of visited points for BFS
- */
-class HashCoords {
-public:
-	std::size_t operator()(const std::pair<int, int> &p) const {
-		return p.first * 31 + p.second;
-	}
-};
-
 /*
  * Helper function to update coordinates (x, y)
  */
@@ -135,7 +126,8 @@ void updatePos (std::pair<int, int> &p, int dir) {
 
 int runDepth (std::vector<long> inputVals) {
 	std::deque<std::pair<std::pair<int, int>, std::vector<long>>> queue;
-	std::unordered_map<std::pair<int, int>, int, HashCoords> visited;
+	// depth of each visited point (x, y), 0 if not yet visited
+	SparseGrid<int> visited;
 	std::pair<int, int> currPos = {0, 0};
 	queue.push_back({currPos, inputVals});
 
@@ -143,7 +135,7 @@ int runDepth (std::vector<long> inputVals) {
 
 	while (queue.size()) {
 		currPos = queue.front().first;
-		int& currDepth = visited[currPos];
+		int& currDepth = visited.at(currPos.first, currPos.second);
 
 		if (currDepth > maxDepth) {
 			maxDepth = currDepth;
@@ -156,9 +148,10 @@ int runDepth (std::vector<long> inputVals) {
 			std::vector<long> currVals = queue.front().second;
 			long output = processInput(currVals, i);
 
-			if (output && !visited[currPos]) {
+			int& nextDepth = visited.at(currPos.first, currPos.second);
+			if (output && !nextDepth) {
 				queue.push_back({currPos, currVals});
-				visited[currPos] = visited[prevPos] + 1;
+				nextDepth = visited.at(prevPos.first, prevPos.second) + 1;
 //				std::cout << currPos.first << " " << currPos.second << " " << visited[currPos] << std::endl;
 			}
 		}
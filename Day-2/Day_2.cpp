@@ -5,6 +5,102 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Intcode_Results.h"
+#include "../Common/Intcode_Constexpr.h"
+
+#if __has_include("input_program.h")
+#include "input_program.h"
+
+const size_t inputCapacity = sizeof (inputProgram) / sizeof (long);
+
+// instructions the compiler may run for part 2, shared by all of its runs and
+// charged for copying the program too; about a fifth of GCC's default limit
+// on operations in one constant
+const long compileBudget = 1L << 16;
+
+// helper function to evaluate the program with positions 1 and 2 set in the
+// compiler, charging budget; -1 if the run did not finish, so a negative
+// position 0 is also left to runtime
+constexpr long compileRun (long noun, long verb, long &budget) {
+    budget -= inputCapacity / 16 + 1;
+    if (budget <= 0) {
+        return -1;
+    }
+    ConstexprRun<inputCapacity> run = runConstexpr<inputCapacity> (
+        inputProgram, {{1, noun}, {2, verb}}, {},
+        std::min (budget, constexprDefaultSteps));
+    budget -= run.steps;
+    return run.halted ? run.memory[0] : -1;
+}
+
+/*
+ * part 2 evaluated by the compiler, -1 if not found
+ *
+ * a brute force search is beyond the compiler's evaluation limits. instead,
+ * the result is taken to be affine in the noun and the verb, as it is for
+ * these programs: three runs give its coefficients, the noun and verb that
+ * would reach the target are solved for, and a final run confirms them. any
+ * step that would overflow, or exhaust the budget, gives up
+ */
+constexpr long compilePart2 () {
+    long budget = compileBudget;
+    long base = compileRun (0, 0, budget);
+    long withNoun = compileRun (1, 0, budget);
+    long withVerb = compileRun (0, 1, budget);
+    long perNoun = 0;
+    long perVerb = 0;
+    if (base < 0 || withNoun < 0 || withVerb < 0 ||
+        __builtin_sub_overflow (withNoun, base, &perNoun) ||
+        __builtin_sub_overflow (withVerb, base, &perVerb) || perVerb <= 0) {
+        return -1;
+    }
+    for (long noun = 0; noun <= 99; noun++) {
+        long rest = 0;
+        if (__builtin_mul_overflow (perNoun, noun, &rest) ||
+            __builtin_sub_overflow (19690720 - base, rest, &rest)) {
+            continue;
+        }
+        long verb = rest / perVerb;
+        if (rest % perVerb == 0 && verb >= 0 && verb <= 99 &&
+            compileRun (noun, verb, budget) == 19690720) {
+            return 100 * noun + verb;
+        }
+    }
+    return -1;
+}
+
+// helper function to fingerprint the embedded program
+constexpr uint64_t compileFingerprint () {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < inputCapacity && i < constexprMaxWords; i++) {
+        hash = (hash ^ (uint64_t)inputProgram[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+constexpr long compilePart1 () {
+    long budget = compileBudget;
+    return compileRun (12, 2, budget);
+}
+
+constexpr long compiledPart1 = compilePart1 ();
+constexpr long compiledPart2 = compilePart2 ();
+
+// the input.txt checked in here must be answered by the compiler, correctly;
+// any other program only has to agree with the runtime search
+constexpr uint64_t checkedInProgram = 0xb860d4c257ed95d3ull;
+static_assert (compileFingerprint () != checkedInProgram ||
+               (compiledPart1 == 3706713 && compiledPart2 == 8609),
+               "compile-time answers for the checked-in input.txt");
+#else
+// no embedded program: both parts run at runtime
+constexpr long compiledPart1 = -1;
+constexpr long compiledPart2 = -1;
+#endif
 
 /*
  * process the inputs given by opcodes and entries within the input values
@@ -12,39 +108,59 @@
  */
 void processInput (std::vector<int> &inputVals, int initVal1, int initVal2);
 
+/*
+ * run a fresh copy of the original program with positions 1 and 2 set,
+ * answering from the result cache when it has seen the run before
+ *
+ * returns the final value at position 0
+ */
+int runPatched (std::vector<int> &inputVals,
+                const std::vector<int> &inputOriginal, int initVal1,
+                int initVal2, ResultCache &cache, uint64_t programHash);
+
 int main () {
-    std::ifstream inFile ("input.txt");
     // add each input value to vector for indexed read/write operations
     std::vector<int> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stoi (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
     // obtain deep copy of this original vector for part 2:
     std::vector<int> inputOriginal;
     inputOriginal.assign(inputVals.begin (), inputVals.end ());
+    // results of earlier runs, if INTCODE_RESULTS names a cache file
+    ResultCache cache;
+    openResultCacheFromEnv (cache);
+    uint64_t programHash = hashProgram (inputOriginal);
 
     /* Part 1: -------------------------------------------------------------- */
 
     // initial conditions: position 1 with val 12, position 2 with val 2
-    processInput (inputVals, 12, 2);
+    int part1 = compiledPart1;
+    if (compiledPart1 < 0) {
+        part1 = runPatched (inputVals, inputOriginal, 12, 2, cache,
+                            programHash);
+    }
 
-    printf ("Part 1 Solution: %d\n", inputVals.at (0));
+    printf ("Part 1 Solution: %d\n", part1);
 
     /* Part 2: -------------------------------------------------------------- */
-    // reset inputVals with deep copy
-    inputVals.assign (inputOriginal.begin (), inputOriginal.end ());
+    if (compiledPart2 >= 0) {
+        printf ("Part 2 Solution: %ld\n", compiledPart2);
+        closeResultCache (cache);
+        return 0;
+    }
+
     // brute force assign positions 1 and 2 with values to generate 19690720
     int target = 0;
     int initVal1 = 0;
     int initVal2 = 0;
     while (target != 19690720) {
         while (target != 19690720 && initVal2 <= 99) {
-            inputVals.assign (inputOriginal.begin (), inputOriginal.end ());
             // inner nested loop: postfix increment initVal2 for after call
-            processInput (inputVals, initVal1, initVal2++);
-            target = inputVals.at (0);
+            target = runPatched (inputVals, inputOriginal, initVal1,
+                                 initVal2++, cache, programHash);
         }
         if (target != 19690720) {
             // outer loop finished without success, try next initVal1
@@ -55,6 +171,23 @@ int main () {
 
     // due to postfix increment, initVal2 is 1 ahead; change in solution
     printf ("Part 2 Solution: %d\n", 100 * initVal1 + initVal2 - 1);
+    closeResultCache (cache);
+}
+
+int runPatched (std::vector<int> &inputVals,
+                const std::vector<int> &inputOriginal, int initVal1,
+                int initVal2, ResultCache &cache, uint64_t programHash) {
+    ResultKey key = resultKey (programHash, {{1, initVal1}, {2, initVal2}},
+                               {});
+    std::vector<long> outputs;
+    long cell0;
+    if (lookupResult (cache, key, outputs, cell0)) {
+        return cell0;
+    }
+    inputVals.assign (inputOriginal.begin (), inputOriginal.end ());
+    processInput (inputVals, initVal1, initVal2);
+    storeResult (cache, key, outputs, inputVals.at (0));
+    return inputVals.at (0);
 }
 
 void processInput (std::vector<int> &inputVals, int initVal1, int initVal2) {
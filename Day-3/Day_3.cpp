@@ -2,192 +2,126 @@
  * Day 3: Given the magnitudes of two wire paths from the same origin point,
  * determine the Manhattan distance between the origin point and the nearest
  * point of intersection between the paths.
+ *
+ * the crossings are found with a sweep line over the segments of both paths
+ * (Common/Wire_Paths.h), giving the answers to both parts in one pass.
+ *
+ * with more than two paths, every pair of paths is also swept, spread over a
+ * thread per core, and reported along with the best crossings of all pairs.
+ *
+ * points given as arguments, "./run x,y ...", are also looked up on every
+ * path through a point index over all paths, printing the fewest steps along
+ * each path to reach each point.
  */
 
 #include <fstream>
-#include <sstream>
 #include <iostream>
-#include <limits>
 #include <vector>
 
-/*
- * Represent the position of each vertex in the path, will always be a corner
- * in the grid in this case. Store address of next vertex in the path.
- */
-struct Vertex {
-    int x;
-    int y;
-    Vertex *next;
-};
-
-/*
- * Get the next vertex from the input element, containing direction and velocity
- */
-Vertex* getNextVertex (std::string &inputElem, Vertex *vertexLast);
-
-/*
- * Determine intersection between two line segments given by begin and end
- * vertices, and return the Manhattan distance from the origin (0, 0)
- */
-int intersectDistance (Vertex *b1, Vertex *e1, Vertex *b2, Vertex *e2);
+#include "../Common/Wire_Paths.h"
 
-int main () {
+int main (int argc, char **argv) {
     std::ifstream inFile ("input.txt");
     // Two paths in input case, but generalize for any number of paths
-    // store pointers to the start of each path parsed from input
-    std::vector<Vertex*> vertexStart;
+    // each stored as contiguous corner and segment arrays
+    std::vector<Wire> wires;
     std::string inputLine;
     while (std::getline (inFile, inputLine)) {
-        // initialize temporary vertex for starting point
-        Vertex *vertexTemp = new Vertex {0, 0, NULL};
-        vertexStart.push_back (vertexTemp);
-
-        // separate each input elem, delimited by commas
-        std::string inputElem;
-        std::istringstream inStream (inputLine);
-        while (std::getline (inStream, inputElem, ',')) {
-            // create new vertex and link to last temporary vertex
-            Vertex *vertexNew = getNextVertex (inputElem, vertexTemp);
-            vertexTemp->next = vertexNew;
-            vertexTemp = vertexNew;
+        if (inputLine.empty () || inputLine == "\r") {
+            continue;
+        }
+        wires.emplace_back ();
+        if (!parseWire (inputLine, wires.back ())) {
+            printf("Invalid direction, input may be invalid!\n");
         }
     }
+    if (wires.size () < 2) {
+        printf ("input.txt must hold at least two paths\n");
+        return 1;
+    }
+
+    // sweep the first two paths once for all of their crossings
+    CrossingSummary summary = summarizeCrossings (wires.at (0), wires.at (1));
 
     /* Part 1: -------------------------------------------------------------- */
-    // double nested loop across first two paths to determine all intersects
-    Vertex *vertex1 = vertexStart.at (0);
-    Vertex *vertex2 = vertexStart.at (1);
-    int minDistance = std::numeric_limits<int>::max ();
-    bool first = true;
-    while (vertex1->next != NULL) {
-        vertex2 = vertexStart.at (1);
-        while (vertex2->next != NULL) {
-            int result = intersectDistance (vertex1, vertex1->next,
-                                            vertex2, vertex2->next);
-            // dirty fix: ignore 0 result from initial intersect
-            if (!first && result < minDistance) {
-                minDistance = result;
-            }
-            vertex2 = vertex2->next;
-            first = false;
-        }
-        vertex1 = vertex1->next;
-    }
+    // closest crossing to the origin by Manhattan distance
 
-    printf ("Part 1 Solution: %d\n", minDistance);
+    printf ("Part 1 Solution: %ld\n", summary.closestDistance);
 
     /* Part 2: -------------------------------------------------------------- */
-    // reuse code from part 1, but early return at "first" intersect
-    // this will be the earliest point, as all vertices stored in relative order
-    minDistance = std::numeric_limits<int>::max ();
-    first = true;
-    bool done = false;
-    vertex1 = vertexStart.at (0);
-    // track displacement for path 1
-    int totalSteps1 = 0;
-    while (vertex1->next != NULL && !done) {
-        // track displacement for path 2
-        int totalSteps2 = 0;
-        vertex2 = vertexStart.at (1);
-        while (vertex2->next != NULL && !done) {
-            int result = intersectDistance (vertex1, vertex1->next,
-                                            vertex2, vertex2->next);
-            // dirty fix: ignore 0 result from initial intersect
-            if (!first && result < minDistance) {
-                // case 1: path 1 is vertical. path 1 gives x, path 2 gives y
-                if (vertex1->y == vertex1->next->y) {
-                    totalSteps2 += std::abs (vertex1->x - vertex2->x);
-                    totalSteps1 += std::abs (vertex2->y - vertex1->y);
-                }
-                // case 2: path 2 is vertical. path 2 gives x, path 1 gives y
-                else {
-                    totalSteps1 += std::abs (vertex2->x - vertex1->x);
-                    totalSteps2 += std::abs (vertex1->y - vertex2->y);
-                }
-                // combine the steps for path 1 and 2, for solution
-                totalSteps1 += totalSteps2;
-                done = true;
+    // fewest combined steps along both paths, over every crossing
+
+    printf ("Part 2 Solution: %ld\n", summary.fewestSteps);
+
+    /* All pairs: ---------------------------------------------------------- */
+
+    if (wires.size () > 2) {
+        std::vector<PairSummary> pairs = summarizeAllPairs (wires);
+        const PairSummary *closest = nullptr;
+        const PairSummary *fewest = nullptr;
+        long numCrossings = 0;
+        for (const PairSummary &pair : pairs) {
+            const CrossingSummary &summary = pair.summary;
+            printf ("Paths %d and %d: closest %ld, fewest steps %ld, "
+                    "%ld crossings\n", pair.wire1 + 1, pair.wire2 + 1,
+                    summary.closestDistance, summary.fewestSteps,
+                    summary.numCrossings);
+            if (summary.numCrossings == 0) {
+                continue;
             }
-            if (!done) {
-                // update displacement before moving to next vertex
-                totalSteps2 += std::abs (vertex2->x - vertex2->next->x);
-                totalSteps2 += std::abs (vertex2->y - vertex2->next->y);
-
-                vertex2 = vertex2->next;
-                first = false;
+            numCrossings += summary.numCrossings;
+            if (closest == nullptr || summary.closestDistance <
+                                      closest->summary.closestDistance) {
+                closest = &pair;
+            }
+            if (fewest == nullptr ||
+                summary.fewestSteps < fewest->summary.fewestSteps) {
+                fewest = &pair;
             }
         }
-        if (!done) {
-            totalSteps1 += std::abs (vertex1->x - vertex1->next->x);
-            totalSteps1 += std::abs (vertex1->y - vertex1->next->y);
-            vertex1 = vertex1->next;
+        printf ("All %zu pairs: %ld crossings", pairs.size (), numCrossings);
+        if (numCrossings > 0) {
+            printf (", closest %ld (paths %d and %d), fewest steps %ld "
+                    "(paths %d and %d)", closest->summary.closestDistance,
+                    closest->wire1 + 1, closest->wire2 + 1,
+                    fewest->summary.fewestSteps, fewest->wire1 + 1,
+                    fewest->wire2 + 1);
         }
+        printf ("\n");
     }
 
-    printf ("Part 2 Solution: %d\n", totalSteps1);
+    /* Point queries: ------------------------------------------------------- */
 
-    /* Both parts completed: Clean up allocated memory ---------------------- */
-    for (Vertex *toDelete : vertexStart) {
-        while (toDelete != NULL) {
-            Vertex *vertexTemp = toDelete->next;
-            delete toDelete;
-            toDelete = vertexTemp;
+    std::vector<std::pair<int, int>> points;
+    for (int arg = 1; arg < argc; arg++) {
+        int x, y;
+        if (sscanf (argv[arg], "%d,%d", &x, &y) != 2) {
+            printf ("%s: expected a point as x,y\n", argv[arg]);
+            continue;
         }
+        points.push_back ({x, y});
     }
-}
-
-Vertex* getNextVertex (std::string &inputElem, Vertex *vertexLast) {
-    // parse direction and magnitude from input elem
-    char direction = inputElem [0];
-    int magnitude = std::stoi (inputElem.substr (1));
-
-    // update x and y from directions: (U)p, (D)own, (L)eft, (R)ight
-    int newX = vertexLast->x;
-    int newY = vertexLast->y;
-    if (direction == 'U') {
-        newY += magnitude;
-    }
-    else if (direction == 'D') {
-        newY -= magnitude;
-    }
-    else if (direction == 'L') {
-        newX -= magnitude;
-    }
-    else if (direction == 'R') {
-        newX += magnitude;
-    }
-    else {
-        printf("Invalid direction, input may be invalid!\n");
+    if (points.empty ()) {
+        return 0;
     }
-
-    // allocate new vertex and return
-    return new Vertex {newX, newY, NULL};
-}
-
-// helper function to determine if valTest is between val1 and val2
-bool between (int valTest, int val1, int val2) {
-    int max = std::max(val1, val2);
-    int min = std::min(val1, val2);
-    return (unsigned)(valTest - min) <= (max - min);
-}
-
-int intersectDistance (Vertex *b1, Vertex *e1, Vertex *b2, Vertex *e2) {
-    // path 1 horizontal, path 2 vertical
-    if (b1->y == e1->y && b2->x == e2->x) {
-        // vertical x values must be between two horizontal x values, vice versa
-        if (between (b2->x, b1->x, e1->x) && between (b1->y, b2->y, e2->y)) {
-            // intersect point given by path 1 y coord, path 2 x coord
-            return std::abs (b2->x) + std::abs (b1->y);
+    WireIndex index (wires);
+    std::vector<WireHit> hits;
+    std::vector<size_t> offsets;
+    index.query (points, hits, offsets);
+    for (size_t p = 0; p < points.size (); p++) {
+        std::vector<long> steps (wires.size (), -1);
+        for (size_t h = offsets[p]; h < offsets[p + 1]; h++) {
+            steps[hits[h].wire] = hits[h].steps;
         }
-    }
-    // path 2 horizontal, path 1 vertical
-    else if (b2->y == e2->y && b1->x == e1->x) {
-        // vertical x values must be between two horizontal x values, vice versa
-        if (between (b1->x, b2->x, e2->x) && between (b2->y, b1->y, e1->y)) {
-            // intersect point given by path 2 y coord, path 1 x coord
-            return std::abs (b2->y) + std::abs (b1->x);
+        printf ("(%d, %d):", points[p].first, points[p].second);
+        for (long wireSteps : steps) {
+            if (wireSteps < 0) {
+                printf (" -");
+            }
+            else {
+                printf (" %ld", wireSteps);
+            }
         }
+        printf ("\n");
     }
-    // did not early return with a distance, return max int value
-    return std::numeric_limits<int>::max ();
 }
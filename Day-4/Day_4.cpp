@@ -6,89 +6,456 @@
  *
  * Additional Part 2 Rule: the two adjacent matching digits is not part of
  *   a larger group of matching digits
+ *
+ * rather than testing every number in the range, the matching numbers up to a
+ * bound are counted with a dynamic program over the bound's digits, so the
+ * bounds may have any number of digits. both parts are counted in one pass.
+ *
+ * for the usual six-digit bounds, every matching six-digit password is found
+ * while compiling, into a sorted array and a bitset per part. a range count is
+ * then two binary searches, and "./run check password ..." tests membership
+ * with one bit test.
+ *
+ * "./run list [part]" also lists the matching passwords for part 1 or 2. they
+ * are generated as non-decreasing digit sequences only, in increasing order,
+ * with the pair rules checked as each digit is added.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <string>
+
+/*
+ * Digits of a number read so far, as far as the rules are concerned
+ */
+struct DigitState {
+    // last digit, or notStarted while only leading zeros were read
+    int prevDigit;
+    // length of the current run of equal digits, capped at 3
+    int runLength;
+    // a run of two or more was seen (part 1)
+    bool pairFound;
+    // a finished run of exactly two was seen (part 2)
+    bool exactPairFound;
+};
+
+const int notStarted = 10;
+// number of distinct DigitState values, for the table of counts
+const int numDigitStates = 11 * 4 * 2 * 2;
+
+/*
+ * Number of matching passwords under each part's rules
+ */
+struct PasswordCounts {
+    uint64_t part1;
+    uint64_t part2;
+};
+
+/*
+ * Append digit to the number read in state. Returns false if the digits
+ * would decrease.
+ */
+constexpr bool nextDigitState (DigitState &state, int digit) {
+    // leading zeros are not part of the number
+    if (state.prevDigit == notStarted) {
+        if (digit > 0) {
+            state.prevDigit = digit;
+            state.runLength = 1;
+        }
+        return true;
+    }
+    // digits must never decrease
+    if (digit < state.prevDigit) {
+        return false;
+    }
+    if (digit == state.prevDigit) {
+        state.runLength = std::min (state.runLength + 1, 3);
+        state.pairFound = true;
+        return true;
+    }
+    // a run ends: only a run of exactly two counts for part 2
+    if (state.runLength == 2) {
+        state.exactPairFound = true;
+    }
+    state.prevDigit = digit;
+    state.runLength = 1;
+    return true;
+}
+
+/*
+ * Whether a whole number in state satisfies the part 1 or 2 rules
+ */
+constexpr bool matchesPart1 (const DigitState &state) {
+    return state.pairFound;
+}
+
+constexpr bool matchesPart2 (const DigitState &state) {
+    // the last run of two has not been ended by a larger digit
+    return state.exactPairFound || state.runLength == 2;
+}
+
+/* Six-digit tables, built by the compiler --------------------------------- */
+
+const int tableDigits = 6;
+const uint32_t tableFirst = 100000;
+const uint32_t tableLast = 999999;
+const size_t tableWords = (tableLast - tableFirst) / 64 + 1;
+
+// helper function to check a six-digit number against a part's rules
+constexpr bool matchesPart (uint32_t value, int part) {
+    int digits [tableDigits] = {0};
+    for (int i = tableDigits - 1; i >= 0; i--) {
+        digits[i] = value % 10;
+        value /= 10;
+    }
+    DigitState state = {notStarted, 0, false, false};
+    for (int digit : digits) {
+        if (!nextDigitState (state, digit)) {
+            return false;
+        }
+    }
+    return part == 1 ? matchesPart1 (state) : matchesPart2 (state);
+}
+
+/*
+ * Visit every six-digit number whose digits never decrease, in increasing
+ * order, as visit (value)
+ */
+template <typename Visitor>
+constexpr void forEachOrdered (Visitor &visit) {
+    int digits [tableDigits] = {1, 1, 1, 1, 1, 1};
+    while (true) {
+        uint32_t value = 0;
+        for (int digit : digits) {
+            value = value * 10 + digit;
+        }
+        visit (value);
+        // advance the rightmost digit below 9, and level the ones after it
+        int i = tableDigits - 1;
+        while (i >= 0 && digits[i] == 9) {
+            i--;
+        }
+        if (i < 0) {
+            return;
+        }
+        digits[i]++;
+        for (int j = i + 1; j < tableDigits; j++) {
+            digits[j] = digits[i];
+        }
+    }
+}
+
+// helper visitor counting the six-digit passwords of a part
+struct TableCounter {
+    int part;
+    size_t count;
+
+    constexpr void operator () (uint32_t value) {
+        count += matchesPart (value, part);
+    }
+};
+
+constexpr size_t countTable (int part) {
+    TableCounter counter = {part, 0};
+    forEachOrdered (counter);
+    return counter.count;
+}
+
+/*
+ * Every six-digit password of a part, sorted, and as a bitset from 100000
+ */
+template <size_t Size>
+struct PasswordTable {
+    int part;
+    size_t size;
+    uint32_t sorted [Size];
+    uint64_t bits [tableWords];
+
+    constexpr void operator () (uint32_t value) {
+        if (matchesPart (value, part)) {
+            sorted[size++] = value;
+            bits[(value - tableFirst) / 64] |=
+                uint64_t (1) << ((value - tableFirst) % 64);
+        }
+    }
+};
+
+template <int Part>
+constexpr PasswordTable<countTable (Part)> buildTable () {
+    PasswordTable<countTable (Part)> table {};
+    table.part = Part;
+    forEachOrdered (table);
+    return table;
+}
+
+constexpr PasswordTable<countTable (1)> part1Table = buildTable<1> ();
+constexpr PasswordTable<countTable (2)> part2Table = buildTable<2> ();
+
+// examples from the puzzle text
+static_assert (matchesPart (111111, 1) && !matchesPart (223450, 1) &&
+               !matchesPart (123789, 1), "part 1 examples");
+static_assert (matchesPart (112233, 2) && !matchesPart (123444, 2) &&
+               matchesPart (111122, 2), "part 2 examples");
+
+/*
+ * Whether a number is a password of a part, by one bit test
+ */
+template <size_t Size>
+bool inTable (const PasswordTable<Size> &table, uint64_t value) {
+    if (value < tableFirst || value > tableLast) {
+        return false;
+    }
+    value -= tableFirst;
+    return table.bits[value / 64] >> (value % 64) & 1;
+}
 
-int main () {
+/*
+ * Number of passwords of a part in [lower, upper], by two binary searches
+ */
+template <size_t Size>
+uint64_t countInTable (const PasswordTable<Size> &table, uint32_t lower,
+                       uint32_t upper) {
+    if (lower > upper) {
+        return 0;
+    }
+    return std::upper_bound (table.sorted, table.sorted + Size, upper) -
+           std::lower_bound (table.sorted, table.sorted + Size, lower);
+}
+
+/*
+ * Count the matching passwords in [1, bound], bound given as decimal digits
+ */
+PasswordCounts countUpTo (const std::string &bound);
+
+/*
+ * Whether text is a non-empty run of decimal digits
+ */
+bool isDecimal (const std::string &text);
+
+/*
+ * Compare two numbers given as decimal digits by value, leading zeros aside:
+ * negative, zero or positive as a is below, equal to or above b
+ */
+int compareDecimal (const std::string &a, const std::string &b);
+
+/*
+ * Call visit (digits, part1, part2) for every password in [lower, upper]
+ * matching the part 1 rules, in increasing order, with whether it also
+ * matches the part 2 rules. digits is only valid during the call.
+ */
+template <typename Visitor>
+void enumeratePasswords (const std::string &lower, const std::string &upper,
+                         Visitor visit);
+
+int main (int argc, char **argv) {
     // parse input, determine upper and lower ranges
     std::ifstream fileIn ("input.txt");
     std::string input;
     std::getline (fileIn, input);
-    int lower = std::stoi (input.substr (0, 6));
-    int upper = std::stoi (input.substr (7));
+    size_t dash = input.find ('-');
+    std::string lower = input.substr (0, dash);
+    std::string upper = input.substr (dash + 1);
+    // drop any trailing whitespace from the upper bound
+    while (!upper.empty () && (upper.back () < '0' || upper.back () > '9')) {
+        upper.pop_back ();
+    }
+    if (!isDecimal (lower) || !isDecimal (upper)) {
+        printf ("input.txt must hold a range of two numbers, lower-upper\n");
+        return 1;
+    }
+    // leading zeros do not change the range, so drop them for every count
+    for (std::string *bound : {&lower, &upper}) {
+        bound->erase (0, std::min (bound->find_first_not_of ('0'),
+                                   bound->size () - 1));
+    }
+
+    // six-digit bounds are answered from the tables
+    PasswordCounts rangeCounts;
+    if (compareDecimal (lower, upper) > 0) {
+        // an empty range
+        rangeCounts = {0, 0};
+    }
+    else if (lower.size () == tableDigits && upper.size () == tableDigits) {
+        uint32_t lowerValue = std::stoul (lower);
+        uint32_t upperValue = std::stoul (upper);
+        rangeCounts.part1 = countInTable (part1Table, lowerValue, upperValue);
+        rangeCounts.part2 = countInTable (part2Table, lowerValue, upperValue);
+    }
+    else {
+        // count both parts up to each bound, and add back the lower bound
+        PasswordCounts upperCounts = countUpTo (upper);
+        PasswordCounts lowerCounts = countUpTo (lower);
+        DigitState lowerState = {notStarted, 0, false, false};
+        bool lowerOrdered = true;
+        for (char c : lower) {
+            lowerOrdered = lowerOrdered && nextDigitState (lowerState, c - '0');
+        }
+        rangeCounts.part1 = upperCounts.part1 - lowerCounts.part1 +
+                            (lowerOrdered && matchesPart1 (lowerState));
+        rangeCounts.part2 = upperCounts.part2 - lowerCounts.part2 +
+                            (lowerOrdered && matchesPart2 (lowerState));
+    }
 
     /* Part 1: -------------------------------------------------------------- */
 
-    // begin guessing across the range
-    int numValid = 0;
-    for (int guess = lower; guess <= upper; guess++) {
-        // accesses least significant digit
-        int prevDigit = guess % 10;
-        int currGuess = guess / 10;
-        bool consecFound = false;
-        // from remaining 5-digit value, access the next least significant
-        while (currGuess > 0) {
-            int currDigit = currGuess % 10;
-            // current digit is leftward of previous; must be smaller or equal
-            if (currDigit > prevDigit) {
-                break;
-            }
-            // must be at least two consecutive digits that are equal
-            if (currDigit == prevDigit) {
-                consecFound = true;
-            }
-            currGuess = currGuess / 10;
-            prevDigit = currDigit;
-        }
-        // loop didn't early return, guess should be zero; valid password guess
-        if (!currGuess && consecFound) {
-            numValid++;
+    printf("Part 1 solution: %lu\n", rangeCounts.part1);
+
+    /* Part 2: -------------------------------------------------------------- */
+
+    printf("Part 2 solution: %lu\n", rangeCounts.part2);
+
+    /* Membership: ---------------------------------------------------------- */
+
+    if (argc > 1 && std::string (argv[1]) == "check") {
+        for (int arg = 2; arg < argc; arg++) {
+            uint64_t value = std::strtoull (argv[arg], nullptr, 10);
+            printf ("%s: part 1 %s, part 2 %s\n", argv[arg],
+                    inTable (part1Table, value) ? "yes" : "no",
+                    inTable (part2Table, value) ? "yes" : "no");
         }
     }
 
-    printf("Part 1 solution: %d\n", numValid);
+    /* Listing: ------------------------------------------------------------- */
 
-    /* Part 2: -------------------------------------------------------------- */
+    if (argc > 1 && std::string (argv[1]) == "list") {
+        bool part2 = argc > 2 && std::string (argv[2]) == "2";
+        enumeratePasswords (lower, upper, [&] (const std::string &digits,
+                                               bool, bool matches2) {
+            if (!part2 || matches2) {
+                printf ("%s\n", digits.c_str ());
+            }
+        });
+    }
+}
+
+bool isDecimal (const std::string &text) {
+    return !text.empty () &&
+           std::all_of (text.begin (), text.end (),
+                        [] (char c) { return c >= '0' && c <= '9'; });
+}
+
+int compareDecimal (const std::string &a, const std::string &b) {
+    size_t aStart = std::min (a.find_first_not_of ('0'), a.size ());
+    size_t bStart = std::min (b.find_first_not_of ('0'), b.size ());
+    // more significant digits is larger, otherwise the first differing digit
+    size_t aLength = a.size () - aStart;
+    size_t bLength = b.size () - bStart;
+    if (aLength != bLength) {
+        return aLength < bLength ? -1 : 1;
+    }
+    return a.compare (aStart, aLength, b, bStart, bLength);
+}
+
+// helper functions to convert a DigitState to and from its table index
+int stateIndex (const DigitState &state) {
+    return ((state.prevDigit * 4 + state.runLength) * 2 + state.pairFound) * 2 +
+           state.exactPairFound;
+}
+
+DigitState indexState (int index) {
+    DigitState state;
+    state.exactPairFound = index % 2;
+    state.pairFound = index / 2 % 2;
+    state.runLength = index / 4 % 4;
+    state.prevDigit = index / 16;
+    return state;
+}
+
+PasswordCounts countUpTo (const std::string &bound) {
+    // numbers already below the bound, by state of their digits so far
+    uint64_t counts [numDigitStates] = {0};
+    // the prefix of the bound itself, while its digits do not decrease
+    DigitState tight = {notStarted, 0, false, false};
+    bool tightOrdered = true;
 
-    // reuse guessing code from Part 1, but add extra condition
-    numValid = 0;
-    for (int guess = lower; guess <= upper; guess++) {
-        // accesses least significant digit
-        int prevDigit = guess % 10;
-        int currGuess = guess / 10;
-
-        // additional rule: check for larger groups of matching numbers
-        bool consecFound = false;
-        // track number of consecutive occurrences for any given digit
-        int numAdjacent = 0;
-        // from remaining 5-digit value, access the next least significant
-        while (currGuess > 0) {
-            int currDigit = currGuess % 10;
-            // current digit is leftward of previous; must be smaller or equal
-            if (currDigit > prevDigit) {
-                break;
+    for (char boundChar : bound) {
+        int boundDigit = boundChar - '0';
+        uint64_t nextCounts [numDigitStates] = {0};
+        // any digit may follow a prefix already below the bound
+        for (int index = 0; index < numDigitStates; index++) {
+            if (counts[index] == 0) {
+                continue;
             }
-            // check consecutive digits, but only valid if not part of larger
-            if (currDigit == prevDigit) {
-                numAdjacent++;
+            for (int digit = 0; digit <= 9; digit++) {
+                DigitState state = indexState (index);
+                if (nextDigitState (state, digit)) {
+                    nextCounts[stateIndex (state)] += counts[index];
+                }
             }
-            else {
-                // found block of only two adjacent; not part of larger group
-                if (numAdjacent == 1) {
-                    consecFound = true;
+        }
+        // digits below the bound's digit leave the tight prefix
+        if (tightOrdered) {
+            for (int digit = 0; digit < boundDigit; digit++) {
+                DigitState state = tight;
+                if (nextDigitState (state, digit)) {
+                    nextCounts[stateIndex (state)]++;
                 }
-                numAdjacent = 0;
             }
-            currGuess = currGuess / 10;
-            prevDigit = currDigit;
+            tightOrdered = nextDigitState (tight, boundDigit);
         }
-        // loop didn't early return, guess should be zero
-        // last two adjacent could have been final 2 digits checked
-        if (!currGuess && (consecFound || numAdjacent == 1)) {
-            numValid++;
+        std::copy (nextCounts, nextCounts + numDigitStates, counts);
+    }
+
+    PasswordCounts result = {0, 0};
+    for (int index = 0; index < numDigitStates; index++) {
+        DigitState state = indexState (index);
+        result.part1 += matchesPart1 (state) ? counts[index] : 0;
+        result.part2 += matchesPart2 (state) ? counts[index] : 0;
+    }
+    if (tightOrdered) {
+        result.part1 += matchesPart1 (tight);
+        result.part2 += matchesPart2 (tight);
+    }
+    return result;
+}
+
+// helper function to extend digits[0, pos) by every digit allowed by the
+// rules and by the bounds, when the prefix still equals a bound's prefix
+template <typename Visitor>
+void extendPassword (std::string &digits, size_t pos, const DigitState &state,
+                     const std::string *lower, const std::string *upper,
+                     Visitor &visit) {
+    if (pos == digits.size ()) {
+        if (matchesPart1 (state)) {
+            visit (digits, true, matchesPart2 (state));
         }
+        return;
+    }
+    // digits never decrease, and the first one is not a leading zero
+    int first = pos == 0 ? 1 : state.prevDigit;
+    int last = 9;
+    if (lower != nullptr) {
+        first = std::max (first, (*lower)[pos] - '0');
+    }
+    if (upper != nullptr) {
+        last = (*upper)[pos] - '0';
     }
+    for (int digit = first; digit <= last; digit++) {
+        DigitState next = state;
+        nextDigitState (next, digit);
+        digits[pos] = '0' + digit;
+        // a bound stays in force only while the prefix equals it
+        extendPassword (digits, pos + 1, next,
+                        lower != nullptr && digit == (*lower)[pos] - '0' ?
+                            lower : nullptr,
+                        upper != nullptr && digit == last ? upper : nullptr,
+                        visit);
+    }
+}
 
-    printf("Part 2 solution: %d\n", numValid);
+template <typename Visitor>
+void enumeratePasswords (const std::string &lower, const std::string &upper,
+                         Visitor visit) {
+    // passwords of each length in turn, bounded only at the bounds' lengths
+    for (size_t length = std::max<size_t> (lower.size (), 1);
+         length <= upper.size (); length++) {
+        std::string digits (length, '0');
+        DigitState start = {notStarted, 0, false, false};
+        extendPassword (digits, 0, start,
+                        length == lower.size () ? &lower : nullptr,
+                        length == upper.size () ? &upper : nullptr, visit);
+    }
 }
@@ -15,6 +15,25 @@
 #include <fstream>
 #include <vector>
 
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Intcode_Constexpr.h"
+
+#if __has_include("input_program.h")
+#include "input_program.h"
+
+const size_t inputCapacity = sizeof (inputProgram) / sizeof (long);
+
+// both diagnostic runs, evaluated by the compiler
+constexpr ConstexprRun<inputCapacity> compiledPart1 =
+    runConstexpr<inputCapacity> (inputProgram, {}, {1});
+constexpr ConstexprRun<inputCapacity> compiledPart2 =
+    runConstexpr<inputCapacity> (inputProgram, {}, {5});
+#else
+// no embedded program: empty runs that never halted, both parts run at runtime
+constexpr ConstexprRun<1> compiledPart1 {};
+constexpr ConstexprRun<1> compiledPart2 {};
+#endif
+
 /*
  * process the inputs given by opcodes and entries within the input values
  * pass vector by reference for performance
@@ -41,14 +60,21 @@ void parseOpcode (int &opcode, int &mode1, int &mode2, int &mode3);
  */
 int runOpcode (std::vector<int> &inputVals, int &index, int input);
 
+/*
+ * prints the outputs of a run evaluated by the compiler, as runOpcode would
+ *
+ * returns false, printing nothing, if the run did not finish
+ */
+template <size_t Capacity>
+bool printCompiled (const ConstexprRun<Capacity> &run);
+
 int main () {
-    std::ifstream inFile ("input.txt");
     // add each input value to vector for indexed read/write operations
     std::vector<int> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stoi (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
     // obtain deep copy of this original vector for part 2:
     std::vector<int> inputOriginal;
@@ -57,7 +83,9 @@ int main () {
     /* Part 1: -------------------------------------------------------------- */
 
     // initial conditions: input = 1
-    processInput (inputVals, 1);
+    if (!printCompiled (compiledPart1)) {
+        processInput (inputVals, 1);
+    }
 
     printf ("Part 1 Solution: See last nonzero output\n");
 
@@ -66,11 +94,24 @@ int main () {
     inputVals.assign (inputOriginal.begin (), inputOriginal.end ());
 
 //     initial conditions: input = 5
-    processInput (inputVals, 5);
+    if (!printCompiled (compiledPart2)) {
+        processInput (inputVals, 5);
+    }
 
     printf ("Part 2 Solution: See last output\n");
 }
 
+template <size_t Capacity>
+bool printCompiled (const ConstexprRun<Capacity> &run) {
+    if (!run.halted) {
+        return false;
+    }
+    for (int i = 0; i < run.numOutputs; i++) {
+        printf ("output: %d\n", (int)run.outputs[i]);
+    }
+    return true;
+}
+
 void processInput (std::vector<int> &inputVals, int input) {
     // iterate through inputs individually; opcodes not at fixed positions
     int i = 0;
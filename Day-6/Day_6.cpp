@@ -4,138 +4,56 @@
  *
  * If A orbits B, and B orbits C, then A also orbits C. Part 1: Output the total
  * number of pairwise orbits within the total structure.
- */
-
-#include <unordered_map>
-#include <unordered_set>
-#include <vector>
-#include <iostream>
-#include <fstream>
-#include <limits>
-
-/*
- * each object contains a list of all the other objects that directly orbit it.
- * an object also stores the object that it directly orbits.
- */
-struct Object {
-    std::vector<Object*> orbits;
-    Object *orbiting;
-    // part 2: searching across objects, needs flag to check if already searched
-    bool searched;
-};
-
-/*
- * attempts to find memory address of an object specified by its name.
- * if object does not exist yet, allocates a new object with that name.
  *
- * returns the pointer of the object under the name.
- */
-Object* findObject (std::unordered_map<std::string, Object*> &objects,
-                  std::string &objectName);
-
-/*
- * recursively totals the number of direct and indirect orbits around a single
- * object
+ * the orbits of an object are its depth below the root, so part 1 is the sum
+ * of all depths, found in one pass down from the root.
+ *
+ * objects are interned to integer IDs as the map is parsed, and the tree is
+ * kept as flat arrays of parents, children and depths (Common/Orbit_Map.h).
+ *
+ * part 2 and any pairs of objects given as arguments, "./run A B ...", are
+ * answered through the lowest common ancestor of the two objects.
  */
-int countOrbits (Object *base);
 
-/*
- * recursive backtracking solution to determine the shortest distance between
- * any two objects, determined by number of intermediate objects between
- */
-int search (Object *start, Object *target, int currDistance);
+#include <iostream>
 
-int main () {
-    // mapping of an object's name to the location of its corresponding struct
-    std::unordered_map<std::string, Object*> objects;
+#include "../Common/Orbit_Map.h"
 
-    std::ifstream inFile ("input.txt");
-    std::string line;
-    // part 2: need to identify starting position and target position
-    Object *start = nullptr;
-    Object *target = nullptr;
-    while (std::getline (inFile, line)) {
-        // object on the right directly orbits object on the left
-        std::string base = line.substr (0, 3);
-        std::string orbiter = line.substr (4, 3);
-        Object *objectBase = findObject (objects, base);
-        Object *objectOrbiter = findObject (objects, orbiter);
-        // link the two objects by their direct orbit
-        objectBase->orbits.push_back (objectOrbiter);
-        objectOrbiter->orbiting = objectBase;
-        // check for start/target names; only consider base object in this case
-        if (orbiter == "SAN") {
-            target = objectBase;
-        }
-        if (orbiter == "YOU") {
-            start = objectBase;
-        }
+int main (int argc, char **argv) {
+    OrbitMap map;
+    if (!loadOrbitMap ("input.txt", map)) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
 
     /* Part 1: -------------------------------------------------------------- */
 
-    int totalOrbits = 0;
-    // must call counting function starting from every object in the map
-    for (std::pair<std::string, Object*> entry : objects) {
-        totalOrbits += countOrbits (entry.second);
-    }
     // counted all direct/indirect orbits around every object
-    printf ("Part 1 Solution: %d\n", totalOrbits);
+    printf ("Part 1 Solution: %ld\n", totalOrbits (map));
 
     /* Part 2: -------------------------------------------------------------- */
 
-    // search for shortest path between start and target objects
-    printf ("Part 2 Solution: %d\n", search (start, target, 0));
-}
-
-int countOrbits (Object *base) {
-    int numDirect = base->orbits.size ();
-    // count indirect orbits by calling recursively on all direct orbits
-    int numIndirect = 0;
-    for (Object *direct : base->orbits) {
-        numIndirect += countOrbits (direct);
+    // transfers between the objects that YOU and SAN orbit
+    int start = findObject (map, "YOU");
+    int target = findObject (map, "SAN");
+    long distance = -1;
+    if (start >= 0 && target >= 0) {
+        distance = transfers (map, map.parent[start], map.parent[target]);
     }
-    return numDirect + numIndirect;
-}
-
-int search (Object *current, Object *target, int currDistance) {
-    // check if reached target
-    if (current == target) {
-        return currDistance;
-    }
-    // mark current object as visited
-    current->searched = true;
-    // check orbiting object, if not null
-    int currMin = std::numeric_limits<int>::max ();
-    if (current->orbiting != nullptr && !current->orbiting->searched) {
-        currMin = search (current->orbiting, target, currDistance + 1);
-    }
-    // check all orbiting objects
-    for (Object *orbiter : current->orbits) {
-        if (!orbiter->searched) {
-            int result = search (orbiter, target, currDistance + 1);
-
-            if (result < currMin) {
-                currMin = result;
-            }
-        }
-    }
-    return currMin;
-}
+    printf ("Part 2 Solution: %ld\n", distance);
 
-Object* findObject (std::unordered_map<std::string, Object*> &objects,
-                    std::string &objectName) {
-    // iterator for unordered map lookup
-    std::unordered_map<std::string, Object*>::const_iterator search;
-    search = objects.find (objectName);
+    /* Transfer queries: ---------------------------------------------------- */
 
-    Object *pObject;
-    if (search == objects.end ()) {
-        pObject = new Object;
-        objects.insert (std::make_pair(objectName, pObject));
+    // transfers between each pair of named objects, in one batch
+    std::vector<std::pair<int, int>> queries;
+    for (int arg = 1; arg + 1 < argc; arg += 2) {
+        queries.push_back ({findObject (map, argv[arg]),
+                            findObject (map, argv[arg + 1])});
     }
-    else {
-        pObject = search->second;
+    std::vector<long> results;
+    transfers (map, queries, results);
+    for (size_t q = 0; q < queries.size (); q++) {
+        printf ("%s to %s: %ld\n", argv[2 * q + 1], argv[2 * q + 2],
+                results[q]);
     }
-    return pObject;
 }
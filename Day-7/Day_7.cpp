@@ -12,6 +12,9 @@
 #include <vector>
 #include <algorithm>
 
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Intcode_Results.h"
+
 /*
  * process the inputs given by opcodes and entries within the input values
  * pass vector by reference for performance
@@ -31,8 +34,12 @@ int processInputLoop (std::vector<int> &inputVals, int input1, int input2,
 
 /*
  * Run the sequence of five execution sequences and outputs the final result
+ *
+ * Each amplifier run is answered from the result cache when it has been seen
+ * before, keyed by its phase and input signal
  */
-int runSequence (int sequence[], std::vector<int> &inputFixed);
+int runSequence (int sequence[], std::vector<int> &inputFixed,
+                 ResultCache &cache, uint64_t programHash);
 
 /*
  * Part 2: runs according to the feedback loop
@@ -58,21 +65,24 @@ int runOpcode (std::vector<int> &inputVals, int &index, int input,
                int &writeCount, bool &waitFlag, int &output);
 
 int main () {
-    std::ifstream inFile ("input.txt");
     // add each input value to vector for indexed read/write operations
     std::vector<int> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stoi (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
+    // results of earlier runs, if INTCODE_RESULTS names a cache file
+    ResultCache cache;
+    openResultCacheFromEnv (cache);
+    uint64_t programHash = hashProgram (inputVals);
 
 //    /* Part 1: -------------------------------------------------------------- */
     int sequence[] = {0, 1, 2, 3, 4};
     int maxOutput = 0;
     // check all permutations of sequence
     do {
-        int result = runSequence (sequence, inputVals);
+        int result = runSequence (sequence, inputVals, cache, programHash);
         if (result > maxOutput) {
             maxOutput = result;
         }
@@ -94,18 +104,28 @@ int main () {
     } while (std::next_permutation (sequence2, sequence2 + 5));
 
     printf ("Part 2 Solution: %d\n", maxOutput);
+    closeResultCache (cache);
 }
 
-int runSequence (int sequence[], std::vector<int> &inputFixed) {
+int runSequence (int sequence[], std::vector<int> &inputFixed,
+                 ResultCache &cache, uint64_t programHash) {
     std::vector<int> inputVals;
 
     // second input starts at 0 for the first iteration
     int input2 = 0;
     for (int i = 0; i < 5; i++) {
+        ResultKey key = resultKey (programHash, {}, {sequence[i], input2});
+        std::vector<long> outputs;
+        long cell0;
+        if (lookupResult (cache, key, outputs, cell0) && outputs.size () == 1) {
+            input2 = outputs[0];
+            continue;
+        }
         // reset the memory input
         inputVals.assign (inputFixed.begin (), inputFixed.end ());
         // the result of processing the input will be used for next iteration
         input2 = processInput (inputVals, sequence[i], input2);
+        storeResult (cache, key, {input2}, inputVals.at (0));
     }
     // finished iterations, last result stored in input 2
     return input2;
@@ -7,6 +7,8 @@
 #include <fstream>
 #include <vector>
 
+#include "../Common/Intcode_Loader.h"
+
 /*
  * process the inputs given by opcodes and entries within the input values
  * pass vector by reference for performance
@@ -32,13 +34,12 @@ int runOpcode (std::vector<long> &inputVals, int &index, long input,
                long &output, int &relativeBase);
 
 int main () {
-    std::ifstream inFile ("input.txt");
     // add each input value to vector for indexed read/write operations
     std::vector<long> inputVals;
-    std::string val;
-    // use getline for parse, with each input "line" delimited by commas
-    while (std::getline (inFile, val, ',')) {
-        inputVals.push_back (std::stol (val));
+    // parse the comma separated input in place from the mapped file
+    if (!loadProgram ("input.txt", inputVals) || inputVals.empty ()) {
+        printf ("cannot read input.txt\n");
+        return 1;
     }
     // obtain deep copy of this original vector for part 2:
     std::vector<long> inputOriginal;
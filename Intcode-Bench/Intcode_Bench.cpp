@@ -0,0 +1,234 @@
+/*
+ * Intcode throughput benchmark: run every corpus program on every engine and
+ * print one CSV row per pair, to be compared across commits.
+ *
+ * Usage: ./run [scale] [label] [repeats]
+ *        ./run dump [scale]   write each corpus program to <name>.txt
+ *        ./run trace [scale]  memory working-set summary of each program
+ *        ./run trace program.txt [input ...]
+ *
+ * scale multiplies the work of every program (1 is a few million
+ * instructions each), label is copied into every row (a commit hash, say) and
+ * the best of repeats runs is reported. Rows whose output does not match the
+ * program's model are marked in the ok column.
+ *
+ * Each program and engine pair runs in its own forked child, so maxrss_kb is
+ * the peak resident set of that run alone rather than of the whole benchmark.
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Common/Intcode.h"
+#include "../Common/Intcode_Corpus.h"
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Intcode_Trace.h"
+
+/*
+ * Result of the best run of one program on one engine
+ */
+struct BenchResult {
+    long instructions;
+    double seconds;
+    // bytes held by the machine's memory and engine scratch after the run
+    size_t machineBytes;
+    bool ok;
+};
+
+/*
+ * Run a program to completion on an engine, repeats times, keeping the best
+ */
+BenchResult benchEngine (IntcodeEngine engine,
+                         const std::vector<long> &program, long input,
+                         long expected, int repeats);
+
+/*
+ * Run benchEngine in a forked child and read the child's peak resident set
+ * into maxrssKb, -1 if the child could not be started
+ */
+BenchResult benchInChild (IntcodeEngine engine,
+                          const std::vector<long> &program, long input,
+                          long expected, int repeats, long &maxrssKb);
+
+/*
+ * Write each corpus program as comma separated text, for the other tools
+ */
+void dumpCorpus (int scale);
+
+/*
+ * Run one program under the memory tracer and print its working set
+ */
+void traceProgram (const char *name, const std::vector<long> &program,
+                   const std::vector<long> &inputs);
+
+int main (int argc, char *argv[]) {
+    if (argc > 1 && strcmp (argv[1], "dump") == 0) {
+        dumpCorpus (argc > 2 ? std::stoi (argv[2]) : 1);
+        return 0;
+    }
+    if (argc > 1 && strcmp (argv[1], "trace") == 0) {
+        // a program file with its inputs, or else the whole corpus
+        if (argc > 2 && !isdigit (argv[2][0])) {
+            std::vector<long> program;
+            if (!loadProgram (argv[2], program)) {
+                printf ("could not load %s\n", argv[2]);
+                return 2;
+            }
+            std::vector<long> inputs;
+            for (int i = 3; i < argc; i++) {
+                inputs.push_back (std::stol (argv[i]));
+            }
+            traceProgram (argv[2], program, inputs);
+            return 0;
+        }
+        int scale = argc > 2 ? std::stoi (argv[2]) : 1;
+        for (int p = 0; p < intcodeCorpusSize; p++) {
+            const CorpusProgram &corpus = intcodeCorpus[p];
+            traceProgram (corpus.name, corpus.build (),
+                          {corpus.inputFor (scale)});
+        }
+        return 0;
+    }
+    int scale = argc > 1 ? std::stoi (argv[1]) : 1;
+    std::string label = argc > 2 ? argv[2] : "local";
+    int repeats = argc > 3 ? std::stoi (argv[3]) : 3;
+
+    printf ("label,program,input,engine,instructions,seconds,mips,"
+            "ns_per_dispatch,machine_bytes,maxrss_kb,ok\n");
+    fflush (stdout);
+    bool allOk = true;
+    for (int p = 0; p < intcodeCorpusSize; p++) {
+        const CorpusProgram &corpus = intcodeCorpus[p];
+        std::vector<long> program = corpus.build ();
+        long input = corpus.inputFor (scale);
+        long expected = corpus.expected (input);
+        for (int e = 0; e < intcodeNumEngines; e++) {
+            long maxrssKb;
+            BenchResult result = benchInChild (intcodeEngines[e].run, program,
+                                               input, expected, repeats,
+                                               maxrssKb);
+            printf ("%s,%s,%ld,%s,%ld,%.6f,%.2f,%.3f,%zu,%ld,%s\n",
+                    label.c_str (), corpus.name, input,
+                    intcodeEngines[e].name, result.instructions,
+                    result.seconds,
+                    result.instructions / result.seconds / 1e6,
+                    result.seconds * 1e9 / result.instructions,
+                    result.machineBytes, maxrssKb,
+                    result.ok ? "yes" : "NO");
+            fflush (stdout);
+            allOk = allOk && result.ok;
+        }
+    }
+    return allOk ? 0 : 1;
+}
+
+BenchResult benchEngine (IntcodeEngine engine,
+                         const std::vector<long> &program, long input,
+                         long expected, int repeats) {
+    BenchResult best {0, 0, 0, true};
+    for (int r = 0; r < repeats; r++) {
+        IntcodeMachine machine;
+        initMachine (machine, program, {input});
+        std::chrono::steady_clock::time_point start;
+        start = std::chrono::steady_clock::now ();
+        engine (machine, LONG_MAX);
+        std::chrono::duration<double> elapsed;
+        elapsed = std::chrono::steady_clock::now () - start;
+
+        bool ok = machine.status == INTCODE_HALTED &&
+                  machine.outputs.size () == 1 &&
+                  machine.outputs[0] == expected;
+        if (!r || elapsed.count () < best.seconds) {
+            best.instructions = machine.steps;
+            best.seconds = elapsed.count ();
+            best.machineBytes = machine.memory.capacity () * sizeof (long) +
+                                machine.decoded.capacity () * sizeof (uint32_t);
+        }
+        best.ok = best.ok && ok;
+    }
+    return best;
+}
+
+BenchResult benchInChild (IntcodeEngine engine,
+                          const std::vector<long> &program, long input,
+                          long expected, int repeats, long &maxrssKb) {
+    // without a child, run here; the peak is then not the engine's own
+    int fds[2];
+    if (pipe (fds) != 0) {
+        maxrssKb = -1;
+        return benchEngine (engine, program, input, expected, repeats);
+    }
+    pid_t pid = fork ();
+    if (pid < 0) {
+        close (fds[0]);
+        close (fds[1]);
+        maxrssKb = -1;
+        return benchEngine (engine, program, input, expected, repeats);
+    }
+    if (pid == 0) {
+        close (fds[0]);
+        BenchResult result = benchEngine (engine, program, input, expected,
+                                          repeats);
+        ssize_t written = write (fds[1], &result, sizeof (result));
+        _exit (written == sizeof (result) ? 0 : 1);
+    }
+
+    close (fds[1]);
+    BenchResult result {0, 0, 0, false};
+    bool received = read (fds[0], &result, sizeof (result)) ==
+                    sizeof (result);
+    close (fds[0]);
+    int status = 0;
+    struct rusage usage;
+    maxrssKb = wait4 (pid, &status, 0, &usage) == pid ? usage.ru_maxrss : -1;
+    // a child that crashed or failed to report counts as a mismatch
+    if (!received || !WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+        result.ok = false;
+    }
+    return result;
+}
+
+void dumpCorpus (int scale) {
+    for (int p = 0; p < intcodeCorpusSize; p++) {
+        const CorpusProgram &corpus = intcodeCorpus[p];
+        std::vector<long> program = corpus.build ();
+        std::string path = std::string (corpus.name) + ".txt";
+        FILE *out = fopen (path.c_str (), "w");
+        if (out == nullptr) {
+            printf ("could not write %s\n", path.c_str ());
+            continue;
+        }
+        for (size_t i = 0; i < program.size (); i++) {
+            fprintf (out, "%s%ld", i ? "," : "", program[i]);
+        }
+        fprintf (out, "\n");
+        fclose (out);
+        printf ("%s: %zu words, input %ld, expected output %ld\n",
+                path.c_str (), program.size (), corpus.inputFor (scale),
+                corpus.expected (corpus.inputFor (scale)));
+    }
+}
+
+void traceProgram (const char *name, const std::vector<long> &program,
+                   const std::vector<long> &inputs) {
+    IntcodeMachine machine;
+    initMachine (machine, program, inputs);
+    MemoryTrace trace;
+    initTrace (trace);
+    runTraced (machine, trace, LONG_MAX);
+    printf ("== %s: %s", name, machine.status == INTCODE_HALTED ? "halted" :
+            machine.status == INTCODE_NEED_INPUT ? "waiting for input" :
+            "fault");
+    if (machine.faultReason != nullptr) {
+        printf (" (%s)", machine.faultReason);
+    }
+    printf (", %zu outputs\n", machine.outputs.size ());
+    printTraceSummary (trace, stdout);
+}
@@ -0,0 +1,534 @@
+/*
+ * Intcode conformance: generate random and mutated Intcode programs, run each
+ * one on every engine in lockstep, one instruction at a time, and report the
+ * first instruction where any engine's state diverges from the reference.
+ *
+ * Usage: ./run [numPrograms] [seed] [program.txt ...]
+ *
+ * Given program files are run as-is with a few common inputs and are also used
+ * as seeds for mutation. Each diverging program is saved as diverge_<n>.txt so
+ * it can be replayed by passing it back in.
+ *
+ * Engines that skip ahead, like the summarizing engine, never do so one
+ * instruction at a time, so every program is also run on each engine in
+ * chunks of many instructions and compared with the reference at the end.
+ * Every third program is a random counted loop to give them work.
+ */
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Common/Intcode.h"
+#include "../Common/Intcode_Asm.h"
+#include "../Common/Intcode_Loader.h"
+
+// instructions run per program before giving up on it, catches infinite loops
+const long stepBudget = 20000;
+
+/*
+ * Program to check, with a description for the report
+ */
+struct TestCase {
+    std::string name;
+    std::vector<long> program;
+    std::vector<long> inputs;
+};
+
+/*
+ * Totals across every program run
+ */
+struct Summary {
+    long programs;
+    long steps;
+    long divergences;
+    std::map<std::string, long> endings;
+};
+
+/*
+ * Random well-formed-ish program: mostly valid instructions whose addresses
+ * point back into the code (self-modifying), at small relative offsets, or
+ * far past the end of the program, with occasional bad modes and opcodes
+ */
+std::vector<long> randomProgram (std::mt19937_64 &rng);
+
+/*
+ * Apply a handful of random mutations to an existing program
+ */
+std::vector<long> mutateProgram (std::mt19937_64 &rng,
+                                 const std::vector<long> &program);
+
+/*
+ * Random counted loop over a few variables, mostly affine updates with the
+ * occasional product, comparison, dead jump or write into its own code
+ */
+std::vector<long> loopProgram (std::mt19937_64 &rng);
+
+/*
+ * Run a test case on every engine in lockstep. Returns false on divergence,
+ * after printing the diverging instruction and every engine's state.
+ */
+bool runLockstep (const TestCase &test, Summary &summary);
+
+/*
+ * Run a test case on every engine in chunks of chunkSize instructions and
+ * compare the final states. Returns false on divergence.
+ */
+bool runChunked (const TestCase &test, long chunkSize, Summary &summary);
+
+int main (int argc, char *argv[]) {
+    long numPrograms = argc > 1 ? std::stol (argv[1]) : 2000;
+    unsigned long seed = argc > 2 ? std::stoul (argv[2]) : 2019;
+    std::mt19937_64 rng (seed);
+
+    // programs given on the command line seed the mutation pool
+    std::vector<std::vector<long>> pool;
+    std::vector<TestCase> tests;
+    for (int i = 3; i < argc; i++) {
+        std::vector<long> program;
+        if (!loadProgram (argv[i], program) || program.empty ()) {
+            printf ("could not load %s\n", argv[i]);
+            return 2;
+        }
+        pool.push_back (program);
+        // the inputs used by the puzzle days
+        for (long input : {0L, 1L, 2L, 5L}) {
+            tests.push_back ({std::string (argv[i]) + " input " +
+                              std::to_string (input), program, {input}});
+        }
+    }
+
+    Summary summary {0, 0, 0, {}};
+    for (const TestCase &test : tests) {
+        runLockstep (test, summary) && runChunked (test, stepBudget, summary);
+    }
+    for (long n = 0; n < numPrograms; n++) {
+        TestCase test;
+        // alternate fresh random programs, mutants of earlier programs and
+        // counted loops
+        if (n % 3 == 2) {
+            test.name = "loop #" + std::to_string (n);
+            test.program = loopProgram (rng);
+        }
+        else if (n % 3 == 0 || pool.empty ()) {
+            test.name = "random #" + std::to_string (n);
+            test.program = randomProgram (rng);
+        }
+        else {
+            test.name = "mutant #" + std::to_string (n);
+            test.program = mutateProgram (rng, pool[rng () % pool.size ()]);
+        }
+        int numInputs = rng () % 7;
+        for (int i = 0; i < numInputs; i++) {
+            test.inputs.push_back ((long)(rng () % 21) - 10);
+        }
+        long chunkSize = 1 + rng () % stepBudget;
+        if (!runLockstep (test, summary) ||
+            !runChunked (test, chunkSize, summary)) {
+            std::string path = "diverge_" + std::to_string (n) + ".txt";
+            FILE *out = fopen (path.c_str (), "w");
+            if (out != nullptr) {
+                for (size_t i = 0; i < test.program.size (); i++) {
+                    fprintf (out, "%s%ld", i ? "," : "", test.program[i]);
+                }
+                fprintf (out, "\n");
+                fclose (out);
+                printf ("saved program to %s\n", path.c_str ());
+            }
+        }
+        // keep a bounded pool of programs to mutate further
+        if (pool.size () < 64) {
+            pool.push_back (test.program);
+        }
+        else {
+            pool[rng () % pool.size ()] = test.program;
+        }
+    }
+
+    printf ("engines:");
+    for (int e = 0; e < intcodeNumEngines; e++) {
+        printf (" %s", intcodeEngines[e].name);
+    }
+    printf ("\nprograms: %ld, instructions: %ld, divergences: %ld\n",
+            summary.programs, summary.steps, summary.divergences);
+    for (std::pair<const std::string, long> &entry : summary.endings) {
+        printf ("  %-32s %ld\n", entry.first.c_str (), entry.second);
+    }
+    return summary.divergences ? 1 : 0;
+}
+
+std::vector<long> randomProgram (std::mt19937_64 &rng) {
+    const long opcodes[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 99};
+    int length = 8 + rng () % 120;
+    std::vector<long> program;
+    // usually start by moving the relative base somewhere
+    if (rng () % 3) {
+        program.push_back (109);
+        program.push_back ((long)(rng () % 400) - 100);
+    }
+    while ((int)program.size () < length) {
+        long opcode = opcodes[rng () % 10];
+        // rare invalid opcodes
+        if (rng () % 50 == 0) {
+            opcode = 10 + rng () % 89;
+        }
+        int numParams = intcodeNumParams (opcode);
+        long word = opcode;
+        long scale = 100;
+        std::vector<long> params;
+        for (int i = 0; i < numParams; i++) {
+            int mode = rng () % 3;
+            // rare invalid modes
+            if (rng () % 40 == 0) {
+                mode = 3 + rng () % 7;
+            }
+            word += mode * scale;
+            scale *= 10;
+            long param;
+            int pick = rng () % 20;
+            // jump targets: immediate offsets into the program
+            if ((opcode == 5 || opcode == 6) && i == 1 && mode == 1) {
+                param = rng () % (length + 2);
+            }
+            else if (mode == 1) {
+                param = (long)(rng () % 41) - 20;
+            }
+            else if (mode == 2 && pick < 14) {
+                param = (long)(rng () % 41) - 20;
+            }
+            // self-modifying: addresses into the code itself
+            else if (pick < 14) {
+                param = rng () % (length + 4);
+            }
+            // far addresses, past the program, within the address limit
+            else if (pick < 18) {
+                param = length + rng () % (1 << 20);
+            }
+            // anything at all, including huge and negative values
+            else {
+                param = (long)rng ();
+            }
+            params.push_back (param);
+        }
+        program.push_back (word);
+        program.insert (program.end (), params.begin (), params.end ());
+    }
+    program.push_back (99);
+    // some data cells after the code
+    int numData = rng () % 8;
+    for (int i = 0; i < numData; i++) {
+        program.push_back ((long)(rng () % 2001) - 1000);
+    }
+    return program;
+}
+
+std::vector<long> loopProgram (std::mt19937_64 &rng) {
+    IntcodeAsm a;
+    int numVars = 3 + rng () % 4;
+    // variables by position, or relative to a base pointing at them
+    bool relative = rng () % 4 == 0;
+    std::vector<AsmArg> vars;
+    for (int v = 0; v < numVars; v++) {
+        vars.push_back (relative ? rel (v) :
+                        posLabel ("v" + std::to_string (v)));
+    }
+    // an operand: variable, small immediate, or the loop limit
+    auto operand = [&] () {
+        int pick = rng () % 8;
+        if (pick < 5) {
+            return vars[rng () % numVars];
+        }
+        return pick < 7 ? imm ((long)(rng () % 11) - 5) : posLabel ("limit");
+    };
+    if (relative) {
+        a.arb (immLabel ("v0"));
+    }
+
+    // vars[0] counts by step, usually towards limit (or 0 when tested
+    // directly), tested at the top or the bottom
+    long start = (long)(rng () % 401) - 200;
+    long limit = (long)(rng () % 4001) - 2000;
+    long step = 1 + rng () % 3;
+    int test = rng () % 4;
+    long target = test == 3 ? 0 : limit;
+    if ((target < start) != (rng () % 8 == 0)) {
+        step = -step;
+    }
+    bool topTest = rng () % 2;
+    auto emitTest = [&] (bool exitWhenTrue, AsmArg target) {
+        AsmArg flag = posLabel ("flag");
+        if (test == 0) {
+            a.lt (vars[0], posLabel ("limit"), flag);
+        }
+        else if (test == 1) {
+            a.lt (posLabel ("limit"), vars[0], flag);
+        }
+        else if (test == 2) {
+            a.eq (vars[0], posLabel ("limit"), flag);
+        }
+        else {
+            flag = vars[0];
+        }
+        if (exitWhenTrue) {
+            a.jnz (flag, target);
+        }
+        else {
+            a.jz (flag, target);
+        }
+    };
+    a.label ("head");
+    if (topTest) {
+        emitTest (rng () % 2, immLabel ("exit"));
+    }
+    int numUpdates = 1 + rng () % 5;
+    for (int u = 0; u < numUpdates; u++) {
+        AsmArg dst = vars[1 + rng () % (numVars - 1)];
+        int pick = rng () % 16;
+        if (pick < 8) {
+            a.add (operand (), operand (), dst);
+        }
+        else if (pick < 11) {
+            a.mul (operand (), imm ((long)(rng () % 7) - 3), dst);
+        }
+        else if (pick == 11) {
+            a.mul (operand (), operand (), dst);
+        }
+        else if (pick == 12) {
+            a.lt (operand (), operand (), dst);
+        }
+        else if (pick == 13) {
+            a.jz (imm (1), immLabel ("exit"));
+        }
+        else if (pick == 14) {
+            // copy a word of the loop over another, usually changing it
+            a.add (posLabel ("head", rng () % 4), imm (0),
+                   posLabel ("head", rng () % 4));
+        }
+        else {
+            a.add (operand (), imm ((long)rng ()), dst);
+        }
+    }
+    a.add (vars[0], imm (step), vars[0]);
+    if (topTest) {
+        a.jmp (immLabel ("head"));
+    }
+    else {
+        emitTest (true, immLabel ("head"));
+    }
+    a.label ("exit");
+    for (int v = 0; v < numVars; v++) {
+        a.out (vars[v]);
+    }
+    a.halt ();
+
+    a.var ("limit", limit);
+    a.var ("flag");
+    a.var ("v0", start);
+    for (int v = 1; v < numVars; v++) {
+        a.var ("v" + std::to_string (v), (long)(rng () % 401) - 200);
+    }
+    return a.finish ();
+}
+
+std::vector<long> mutateProgram (std::mt19937_64 &rng,
+                                 const std::vector<long> &program) {
+    std::vector<long> mutant = program;
+    int numMutations = 1 + rng () % 6;
+    for (int m = 0; m < numMutations && !mutant.empty (); m++) {
+        size_t pos = rng () % mutant.size ();
+        switch (rng () % 7) {
+            // flip a mode digit
+            case 0 : {
+                long scale = 100;
+                for (int digit = rng () % 3; digit > 0; digit--) {
+                    scale *= 10;
+                }
+                long mode = (mutant[pos] / scale) % 10;
+                mutant[pos] += ((long)(rng () % 3) - mode) * scale;
+                break;
+            }
+            // swap the opcode for another one
+            case 1 :
+                mutant[pos] = mutant[pos] - mutant[pos] % 100 +
+                              1 + rng () % 9;
+                break;
+            // nudge a parameter
+            case 2 :
+                mutant[pos] += (long)(rng () % 9) - 4;
+                break;
+            // replace with a far address
+            case 3 :
+                mutant[pos] = mutant.size () + rng () % (1 << 20);
+                break;
+            // insert a word, shifting everything after it
+            case 4 :
+                mutant.insert (mutant.begin () + pos, (long)(rng () % 100));
+                break;
+            // delete a word
+            case 5 :
+                mutant.erase (mutant.begin () + pos);
+                break;
+            // plant a halt
+            default :
+                mutant[pos] = 99;
+                break;
+        }
+    }
+    if (mutant.empty ()) {
+        mutant.push_back (99);
+    }
+    return mutant;
+}
+
+// helper function to compare the state an instruction can change
+bool sameState (const IntcodeMachine &a, const IntcodeMachine &b,
+                std::string &what) {
+    if (a.status != b.status) {
+        what = "status";
+    }
+    else if ((a.faultReason == nullptr) != (b.faultReason == nullptr) ||
+             (a.faultReason && strcmp (a.faultReason, b.faultReason))) {
+        what = "fault reason";
+    }
+    else if (a.pc != b.pc) {
+        what = "pc";
+    }
+    else if (a.relativeBase != b.relativeBase) {
+        what = "relative base";
+    }
+    else if (a.memory.size () != b.memory.size ()) {
+        what = "memory size";
+    }
+    else if (a.inputPos != b.inputPos) {
+        what = "inputs used";
+    }
+    else if (a.outputs != b.outputs) {
+        what = "outputs";
+    }
+    else if (a.lastWrite != b.lastWrite) {
+        what = "written address";
+    }
+    else if (a.lastWrite >= 0 &&
+             a.memory[a.lastWrite] != b.memory[b.lastWrite]) {
+        what = "written value";
+    }
+    else {
+        return true;
+    }
+    return false;
+}
+
+// helper function to list memory cells that differ between two machines
+void printMemoryDiff (const IntcodeMachine &a, const IntcodeMachine &b) {
+    size_t size = std::max (a.memory.size (), b.memory.size ());
+    int printed = 0;
+    for (size_t i = 0; i < size && printed < 32; i++) {
+        long valueA = i < a.memory.size () ? a.memory[i] : 0;
+        long valueB = i < b.memory.size () ? b.memory[i] : 0;
+        if (valueA != valueB) {
+            printf ("  [%zu] %ld vs %ld\n", i, valueA, valueB);
+            printed++;
+        }
+    }
+}
+
+bool runLockstep (const TestCase &test, Summary &summary) {
+    std::vector<IntcodeMachine> machines (intcodeNumEngines);
+    for (IntcodeMachine &machine : machines) {
+        initMachine (machine, test.program, test.inputs);
+    }
+    summary.programs++;
+
+    for (long step = 0; step < stepBudget; step++) {
+        // remember the instruction about to run, for the report
+        long pc = machines[0].pc;
+        std::string instruction = disassemble (machines[0].memory, pc);
+        for (int e = 0; e < intcodeNumEngines; e++) {
+            intcodeEngines[e].run (machines[e], 1);
+        }
+        summary.steps++;
+
+        for (int e = 1; e < intcodeNumEngines; e++) {
+            std::string what;
+            if (sameState (machines[0], machines[e], what)) {
+                continue;
+            }
+            printf ("DIVERGENCE in %s: engine %s differs in %s\n",
+                    test.name.c_str (), intcodeEngines[e].name, what.c_str ());
+            printf ("  at step %ld, pc %ld: %s\n", step, pc,
+                    instruction.c_str ());
+            for (int d = 0; d < intcodeNumEngines; d++) {
+                dumpMachine (machines[d], intcodeEngines[d].name);
+            }
+            printf ("memory differences, %s vs %s:\n", intcodeEngines[0].name,
+                    intcodeEngines[e].name);
+            printMemoryDiff (machines[0], machines[e]);
+            summary.divergences++;
+            return false;
+        }
+        if (machines[0].status != INTCODE_RUNNING) {
+            break;
+        }
+    }
+
+    // instructions only compare what they touched; check everything at the end
+    for (int e = 1; e < intcodeNumEngines; e++) {
+        if (machines[0].memory != machines[e].memory) {
+            printf ("DIVERGENCE in %s: engine %s memory differs at the end\n",
+                    test.name.c_str (), intcodeEngines[e].name);
+            printMemoryDiff (machines[0], machines[e]);
+            summary.divergences++;
+            return false;
+        }
+    }
+
+    const IntcodeMachine &result = machines[0];
+    std::string ending = result.status == INTCODE_HALTED ? "halted" :
+                         result.status == INTCODE_NEED_INPUT ? "out of input" :
+                         result.status == INTCODE_RUNNING ? "step budget" :
+                         std::string ("fault: ") + result.faultReason;
+    summary.endings[ending]++;
+    return true;
+}
+
+bool runChunked (const TestCase &test, long chunkSize, Summary &summary) {
+    std::vector<IntcodeMachine> machines (intcodeNumEngines);
+    for (int e = 0; e < intcodeNumEngines; e++) {
+        initMachine (machines[e], test.program, test.inputs);
+        for (long step = 0; step < stepBudget; step += chunkSize) {
+            long chunk = std::min (chunkSize, stepBudget - step);
+            if (intcodeEngines[e].run (machines[e], chunk) < chunk) {
+                break;
+            }
+        }
+    }
+
+    for (int e = 1; e < intcodeNumEngines; e++) {
+        std::string what;
+        bool same = sameState (machines[0], machines[e], what);
+        if (same && machines[0].steps != machines[e].steps) {
+            what = "instructions executed";
+        }
+        else if (same && machines[0].memory != machines[e].memory) {
+            what = "memory";
+        }
+        else if (same) {
+            continue;
+        }
+        printf ("DIVERGENCE in %s: engine %s differs in %s, run in chunks of "
+                "%ld\n", test.name.c_str (), intcodeEngines[e].name,
+                what.c_str (), chunkSize);
+        for (int d = 0; d < intcodeNumEngines; d++) {
+            dumpMachine (machines[d], intcodeEngines[d].name);
+        }
+        printf ("memory differences, %s vs %s:\n", intcodeEngines[0].name,
+                intcodeEngines[e].name);
+        printMemoryDiff (machines[0], machines[e]);
+        summary.divergences++;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,562 @@
+/*
+ * Local Intcode service: a daemon that keeps programs decoded and machines
+ * allocated between runs, so short runs skip process startup, parsing and
+ * memory setup. Clients talk to it over a Unix domain socket.
+ *
+ * Usage: ./run serve socket
+ *        ./run client socket program.txt [input ...]
+ *        ./run bench socket program.txt runs [input ...]
+ *
+ * Protocol: frames of a FrameHeader followed by count 64-bit words, in host
+ * byte order since both ends are on the same machine.
+ *
+ *   LOAD    words: the program           reply LOADED  words: program id
+ *   RUN     words: program id, max       reply OUTPUT* words: outputs so far
+ *           steps, inputs...                   DONE    words: status, steps,
+ *                                                      cell 0, output count
+ *
+ * Every reply echoes the tag of its request. Loading the same program twice
+ * gives the same id. Outputs are streamed in OUTPUT frames while a long run
+ * executes. Requests that arrive together are batched: they are grouped by
+ * program and each group runs back to back on that program's warm machines,
+ * so replies to pipelined RUNs can come back out of order; match them by tag.
+ * A request the server cannot serve gets an ERROR reply.
+ *
+ * The server is a single thread polling every client. Replies are queued per
+ * client and written as the socket accepts them, so a slow reader never
+ * stalls the others.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../Common/Intcode.h"
+#include "../Common/Intcode_Loader.h"
+
+const uint32_t frameMagic = 0x49435356; // "ICSV"
+
+enum FrameType : uint32_t {
+    FRAME_LOAD = 1,
+    FRAME_RUN = 2,
+    FRAME_LOADED = 101,
+    FRAME_OUTPUT = 102,
+    FRAME_DONE = 103,
+    FRAME_ERROR = 199
+};
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t tag;
+    uint32_t count;
+};
+
+// largest frame accepted, in words, and instructions run between output frames
+const uint32_t maxFrameWords = 1u << 24;
+const long outputSlice = 1L << 20;
+// default step limit of a run when the request asks for 0
+const long defaultMaxSteps = 1L << 32;
+
+/*
+ * A loaded program with its pristine decode table and its idle machines
+ */
+struct ServiceProgram {
+    std::vector<long> image;
+    std::vector<uint32_t> decoded;
+    std::vector<IntcodeMachine> idle;
+};
+
+/*
+ * One connected client: bytes read but not yet parsed into frames, and
+ * replies not yet written
+ */
+struct ServiceClient {
+    int fd;
+    std::vector<char> pending;
+    std::vector<char> outgoing;
+};
+
+/*
+ * A parsed request waiting in the current batch
+ */
+struct ServiceRequest {
+    size_t client;
+    FrameHeader header;
+    std::vector<long> words;
+};
+
+/*
+ * Accept clients and serve their requests until killed
+ */
+int serve (const char *path);
+
+/*
+ * Load a program and run it once with the given inputs, printing the outputs
+ */
+int runClient (const char *path, const std::vector<long> &program,
+               const std::vector<long> &inputs);
+
+/*
+ * Pipeline many runs of one program and report the throughput
+ */
+int runBench (const char *path, const std::vector<long> &program, long runs,
+              const std::vector<long> &inputs);
+
+int main (int argc, char *argv[]) {
+    if (argc == 3 && strcmp (argv[1], "serve") == 0) {
+        return serve (argv[2]);
+    }
+    bool client = argc >= 4 && strcmp (argv[1], "client") == 0;
+    bool bench = argc >= 5 && strcmp (argv[1], "bench") == 0;
+    if (!client && !bench) {
+        printf ("usage: %s serve socket\n"
+                "       %s client socket program.txt [input ...]\n"
+                "       %s bench socket program.txt runs [input ...]\n",
+                argv[0], argv[0], argv[0]);
+        return 2;
+    }
+    std::vector<long> program;
+    if (!loadProgram (argv[3], program) || program.empty ()) {
+        printf ("could not load %s\n", argv[3]);
+        return 2;
+    }
+    std::vector<long> inputs;
+    for (int i = client ? 4 : 5; i < argc; i++) {
+        inputs.push_back (std::stol (argv[i]));
+    }
+    if (client) {
+        return runClient (argv[2], program, inputs);
+    }
+    return runBench (argv[2], program, std::stol (argv[4]), inputs);
+}
+
+/* Framing ------------------------------------------------------------------ */
+
+// helper function to write all of a buffer, false if the peer went away
+bool writeAll (int fd, const void *data, size_t size) {
+    const char *bytes = (const char *)data;
+    while (size > 0) {
+        // a closed peer gives EPIPE rather than a SIGPIPE that kills us
+        ssize_t written = send (fd, bytes, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+// helper function to read exactly size bytes, false on end of stream
+bool readAll (int fd, void *data, size_t size) {
+    char *bytes = (char *)data;
+    while (size > 0) {
+        ssize_t got = read (fd, bytes, size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+// helper function to append one frame to a buffer
+void appendFrame (std::vector<char> &out, uint32_t type, uint32_t tag,
+                  const long *words, size_t count) {
+    FrameHeader header {frameMagic, type, tag, (uint32_t)count};
+    const char *bytes = (const char *)&header;
+    out.insert (out.end (), bytes, bytes + sizeof (header));
+    bytes = (const char *)words;
+    out.insert (out.end (), bytes, bytes + count * sizeof (long));
+}
+
+bool sendFrame (int fd, uint32_t type, uint32_t tag, const long *words,
+                size_t count) {
+    std::vector<char> frame;
+    appendFrame (frame, type, tag, words, count);
+    return writeAll (fd, frame.data (), frame.size ());
+}
+
+bool receiveFrame (int fd, FrameHeader &header, std::vector<long> &words) {
+    if (!readAll (fd, &header, sizeof (header)) ||
+        header.magic != frameMagic || header.count > maxFrameWords) {
+        return false;
+    }
+    words.resize (header.count);
+    return readAll (fd, words.data (), header.count * sizeof (long));
+}
+
+// helper function to connect to the service, -1 on failure
+int connectService (const char *path) {
+    int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy (address.sun_path, path, sizeof (address.sun_path) - 1);
+    if (fd < 0 || connect (fd, (sockaddr *)&address, sizeof (address)) < 0) {
+        printf ("could not connect to %s: %s\n", path, strerror (errno));
+        if (fd >= 0) {
+            close (fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/* Server ------------------------------------------------------------------- */
+
+// helper function to find or add a program, returning its id
+long loadServiceProgram (std::vector<ServiceProgram> &programs,
+                         std::map<uint64_t, std::vector<long>> &byHash,
+                         const std::vector<long> &image) {
+    uint64_t hash = hashText ((const char *)image.data (),
+                              image.size () * sizeof (long));
+    for (long id : byHash[hash]) {
+        if (programs[id].image == image) {
+            return id;
+        }
+    }
+    ServiceProgram program;
+    program.image = image;
+    // decode every word up front; data words are simply never looked up
+    program.decoded.resize (image.size ());
+    for (size_t i = 0; i < image.size (); i++) {
+        program.decoded[i] = packInstruction (image[i]);
+    }
+    programs.push_back (program);
+    byHash[hash].push_back (programs.size () - 1);
+    return programs.size () - 1;
+}
+
+// helper function to write as much queued output as the socket takes now,
+// false if the client went away
+bool flushClient (ServiceClient &client) {
+    size_t sent = 0;
+    while (sent < client.outgoing.size ()) {
+        ssize_t written = send (client.fd, client.outgoing.data () + sent,
+                                client.outgoing.size () - sent,
+                                MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += written;
+    }
+    client.outgoing.erase (client.outgoing.begin (),
+                           client.outgoing.begin () + sent);
+    return true;
+}
+
+// helper function to run one request on a warm machine, streaming outputs
+void runServiceRequest (ServiceProgram &program, const ServiceRequest &request,
+                        ServiceClient &client) {
+    IntcodeMachine machine;
+    if (!program.idle.empty ()) {
+        machine = std::move (program.idle.back ());
+        program.idle.pop_back ();
+    }
+    // reset in place: the vectors keep their capacity from earlier runs
+    machine.memory.assign (program.image.begin (), program.image.end ());
+    machine.decoded.assign (program.decoded.begin (), program.decoded.end ());
+    machine.inputs.assign (request.words.begin () + 2, request.words.end ());
+    machine.pc = 0;
+    machine.relativeBase = 0;
+    machine.inputPos = 0;
+    machine.outputs.clear ();
+    machine.status = INTCODE_RUNNING;
+    machine.faultReason = nullptr;
+    machine.steps = 0;
+    machine.limit = intcodeDefaultLimit;
+    machine.lastWrite = -1;
+    machine.loopHints.clear ();
+
+    long maxSteps = request.words[1] > 0 ? request.words[1] : defaultMaxSteps;
+    uint32_t tag = request.header.tag;
+    size_t sent = 0;
+    while (machine.status == INTCODE_RUNNING && machine.steps < maxSteps) {
+        long slice = std::min (outputSlice, maxSteps - machine.steps);
+        if (runSummarized (machine, slice) == 0) {
+            break;
+        }
+        // stream what a long run has produced so far
+        if (machine.outputs.size () > sent && machine.steps < maxSteps &&
+            machine.status == INTCODE_RUNNING) {
+            appendFrame (client.outgoing, FRAME_OUTPUT, tag,
+                         machine.outputs.data () + sent,
+                         machine.outputs.size () - sent);
+            sent = machine.outputs.size ();
+            flushClient (client);
+        }
+    }
+    if (machine.outputs.size () > sent) {
+        appendFrame (client.outgoing, FRAME_OUTPUT, tag,
+                     machine.outputs.data () + sent,
+                     machine.outputs.size () - sent);
+    }
+    long done[] = {machine.status, machine.steps,
+                   machine.memory.empty () ? 0 : machine.memory[0],
+                   (long)machine.outputs.size ()};
+    appendFrame (client.outgoing, FRAME_DONE, tag, done, 4);
+    program.idle.push_back (std::move (machine));
+}
+
+int serve (const char *path) {
+    int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy (address.sun_path, path, sizeof (address.sun_path) - 1);
+    unlink (path);
+    if (listener < 0 ||
+        bind (listener, (sockaddr *)&address, sizeof (address)) < 0 ||
+        listen (listener, 64) < 0) {
+        printf ("could not listen on %s: %s\n", path, strerror (errno));
+        return 1;
+    }
+    printf ("serving on %s\n", path);
+    fflush (stdout);
+    // a client that disconnects must not take the server down with it
+    signal (SIGPIPE, SIG_IGN);
+
+    std::vector<ServiceProgram> programs;
+    std::map<uint64_t, std::vector<long>> byHash;
+    std::vector<ServiceClient> clients;
+    std::vector<char> buffer (1 << 16);
+    while (true) {
+        std::vector<pollfd> fds {{listener, POLLIN, 0}};
+        for (ServiceClient &client : clients) {
+            short events = POLLIN | (client.outgoing.empty () ? 0 : POLLOUT);
+            fds.push_back ({client.fd, events, 0});
+        }
+        if (poll (fds.data (), fds.size (), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            printf ("poll failed: %s\n", strerror (errno));
+            return 1;
+        }
+
+        // gather every complete frame that has arrived into one batch. only
+        // the clients polled this round have an entry in fds
+        std::vector<ServiceRequest> batch;
+        for (size_t c = 0; c + 1 < fds.size (); c++) {
+            ServiceClient &client = clients[c];
+            if (!(fds[c + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            // hung up with nothing left to read
+            if (!(fds[c + 1].revents & POLLIN)) {
+                client.pending.clear ();
+                close (client.fd);
+                client.fd = -1;
+                continue;
+            }
+            ssize_t got = read (client.fd, buffer.data (), buffer.size ());
+            if (got > 0) {
+                client.pending.insert (client.pending.end (), buffer.data (),
+                                       buffer.data () + got);
+            }
+            bool broken = got == 0 || (got < 0 && errno != EINTR);
+            size_t used = 0;
+            while (!broken && client.pending.size () - used >=
+                   sizeof (FrameHeader)) {
+                ServiceRequest request;
+                request.client = c;
+                memcpy (&request.header, client.pending.data () + used,
+                        sizeof (FrameHeader));
+                if (request.header.magic != frameMagic ||
+                    request.header.count > maxFrameWords) {
+                    broken = true;
+                    break;
+                }
+                size_t size = sizeof (FrameHeader) +
+                              request.header.count * sizeof (long);
+                if (client.pending.size () - used < size) {
+                    break;
+                }
+                request.words.resize (request.header.count);
+                memcpy (request.words.data (),
+                        client.pending.data () + used + sizeof (FrameHeader),
+                        request.header.count * sizeof (long));
+                batch.push_back (std::move (request));
+                used += size;
+            }
+            client.pending.erase (client.pending.begin (),
+                                  client.pending.begin () + used);
+            if (broken) {
+                close (client.fd);
+                client.fd = -1;
+            }
+        }
+        // a new client is polled from the next round on
+        if (fds[0].revents & POLLIN) {
+            int fd = accept (listener, nullptr, nullptr);
+            if (fd >= 0) {
+                clients.push_back ({fd, {}, {}});
+            }
+        }
+
+        // loads first, so runs in the same batch can use them
+        std::map<long, std::vector<const ServiceRequest *>> runs;
+        for (const ServiceRequest &request : batch) {
+            ServiceClient &client = clients[request.client];
+            uint32_t tag = request.header.tag;
+            if (request.header.type == FRAME_LOAD) {
+                long id = loadServiceProgram (programs, byHash,
+                                              request.words);
+                appendFrame (client.outgoing, FRAME_LOADED, tag, &id, 1);
+            }
+            else if (request.header.type == FRAME_RUN &&
+                     request.words.size () >= 2) {
+                runs[request.words[0]].push_back (&request);
+            }
+            else {
+                appendFrame (client.outgoing, FRAME_ERROR, tag, nullptr, 0);
+            }
+        }
+        for (std::pair<const long, std::vector<const ServiceRequest *>> &group :
+             runs) {
+            long id = group.first;
+            for (const ServiceRequest *request : group.second) {
+                ServiceClient &client = clients[request->client];
+                if (id < 0 || id >= (long)programs.size ()) {
+                    appendFrame (client.outgoing, FRAME_ERROR,
+                                 request->header.tag, nullptr, 0);
+                    continue;
+                }
+                runServiceRequest (programs[id], *request, client);
+            }
+        }
+
+        std::vector<ServiceClient> open;
+        for (ServiceClient &client : clients) {
+            if (client.fd >= 0 && !flushClient (client)) {
+                close (client.fd);
+                client.fd = -1;
+            }
+            if (client.fd >= 0) {
+                open.push_back (std::move (client));
+            }
+        }
+        clients.swap (open);
+    }
+}
+
+/* Clients ------------------------------------------------------------------ */
+
+// helper function to load a program, returning its id or -1
+long loadRemote (int fd, const std::vector<long> &program) {
+    FrameHeader header;
+    std::vector<long> words;
+    if (!sendFrame (fd, FRAME_LOAD, 0, program.data (), program.size ()) ||
+        !receiveFrame (fd, header, words) || header.type != FRAME_LOADED ||
+        words.size () != 1) {
+        printf ("could not load the program into the service\n");
+        return -1;
+    }
+    return words[0];
+}
+
+// helper function to build a RUN request's words
+std::vector<long> runWords (long id, const std::vector<long> &inputs) {
+    std::vector<long> words {id, 0};
+    words.insert (words.end (), inputs.begin (), inputs.end ());
+    return words;
+}
+
+int runClient (const char *path, const std::vector<long> &program,
+               const std::vector<long> &inputs) {
+    int fd = connectService (path);
+    long id = fd < 0 ? -1 : loadRemote (fd, program);
+    if (id < 0) {
+        return 1;
+    }
+    std::vector<long> words = runWords (id, inputs);
+    sendFrame (fd, FRAME_RUN, 1, words.data (), words.size ());
+    FrameHeader header;
+    while (receiveFrame (fd, header, words)) {
+        if (header.type == FRAME_OUTPUT) {
+            for (long value : words) {
+                printf ("%ld\n", value);
+            }
+            continue;
+        }
+        if (header.type == FRAME_DONE && words.size () == 4) {
+            const char *statusNames[] = {"step limit", "need input", "halted",
+                                         "fault"};
+            bool known = words[0] >= 0 && words[0] < 4;
+            printf ("[%s after %ld instructions, cell 0 = %ld]\n",
+                    known ? statusNames[words[0]] : "unknown status",
+                    words[1], words[2]);
+            close (fd);
+            return words[0] == INTCODE_HALTED ? 0 : 1;
+        }
+        break;
+    }
+    printf ("service error\n");
+    close (fd);
+    return 1;
+}
+
+int runBench (const char *path, const std::vector<long> &program, long runs,
+              const std::vector<long> &inputs) {
+    int fd = connectService (path);
+    long id = fd < 0 ? -1 : loadRemote (fd, program);
+    if (id < 0) {
+        return 1;
+    }
+    std::vector<long> words = runWords (id, inputs);
+    std::chrono::steady_clock::time_point start;
+    start = std::chrono::steady_clock::now ();
+    // keep a window of requests in flight so the server can batch them
+    const long window = 256;
+    long sent = 0;
+    long done = 0;
+    long steps = 0;
+    FrameHeader header;
+    std::vector<long> reply;
+    while (done < runs) {
+        while (sent < runs && sent - done < window) {
+            sendFrame (fd, FRAME_RUN, sent, words.data (), words.size ());
+            sent++;
+        }
+        if (!receiveFrame (fd, header, reply)) {
+            printf ("service went away\n");
+            return 1;
+        }
+        if (header.type == FRAME_DONE) {
+            steps += reply[1];
+            done++;
+        }
+        else if (header.type != FRAME_OUTPUT) {
+            printf ("service error\n");
+            return 1;
+        }
+    }
+    std::chrono::duration<double> elapsed;
+    elapsed = std::chrono::steady_clock::now () - start;
+    printf ("%ld runs, %ld instructions in %.3f s: %.1f us per run\n", runs,
+            steps, elapsed.count (), elapsed.count () * 1e6 / runs);
+    close (fd);
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Specialize an Intcode program for fixed inputs and write the residual
+ * program, so repeated runs with the same inputs skip the work.
+ *
+ * Usage: ./run program.txt residual.txt [input ...]
+ *
+ * The residual is checked before it is written: the original program run on
+ * the inputs and the residual run on none must produce the same outputs and
+ * stop the same way. Residuals of programs that want more input than given
+ * take the rest of their input as the original would.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../Common/Intcode.h"
+#include "../Common/Intcode_Loader.h"
+#include "../Common/Intcode_Specialize.h"
+
+// instructions to run ahead of time before giving up on the rest
+const long specializeBudget = 1L << 30;
+
+/*
+ * Time one run of a program to a stop, returning the machine
+ */
+IntcodeMachine timeRun (const std::vector<long> &program,
+                        const std::vector<long> &inputs, double &seconds);
+
+int main (int argc, char *argv[]) {
+    if (argc < 3) {
+        printf ("usage: %s program.txt residual.txt [input ...]\n", argv[0]);
+        return 2;
+    }
+    std::vector<long> program;
+    if (!loadProgram (argv[1], program)) {
+        printf ("could not load %s\n", argv[1]);
+        return 2;
+    }
+    std::vector<long> inputs;
+    for (int i = 3; i < argc; i++) {
+        inputs.push_back (std::stol (argv[i]));
+    }
+
+    SpecializeResult result;
+    result = specializeProgram (program, inputs, specializeBudget);
+    if (result.faulted) {
+        printf ("program faults on these inputs; nothing to specialize\n");
+        return 1;
+    }
+
+    double originalSeconds;
+    double residualSeconds;
+    IntcodeMachine original = timeRun (program, inputs, originalSeconds);
+    IntcodeMachine residual = timeRun (result.residual, {}, residualSeconds);
+    if (original.outputs != residual.outputs ||
+        original.status != residual.status) {
+        printf ("residual program does not match the original\n");
+        return 1;
+    }
+
+    FILE *out = fopen (argv[2], "w");
+    if (out == nullptr) {
+        printf ("could not write %s\n", argv[2]);
+        return 2;
+    }
+    for (size_t i = 0; i < result.residual.size (); i++) {
+        fprintf (out, "%s%ld", i ? "," : "", result.residual[i]);
+    }
+    fprintf (out, "\n");
+    fclose (out);
+
+    printf ("%s: %s\n", argv[2], result.complete ? "outputs only" :
+            "resumes where the known inputs run out");
+    printf ("words:        %zu -> %zu\n", program.size (),
+            result.residual.size ());
+    printf ("instructions: %ld -> %ld (%ld folded)\n", original.steps,
+            residual.steps, result.stepsFolded);
+    printf ("seconds:      %.6f -> %.6f\n", originalSeconds, residualSeconds);
+    printf ("outputs:     ");
+    for (long value : result.knownOutputs) {
+        printf (" %ld", value);
+    }
+    printf ("\n");
+    return 0;
+}
+
+IntcodeMachine timeRun (const std::vector<long> &program,
+                        const std::vector<long> &inputs, double &seconds) {
+    IntcodeMachine machine;
+    initMachine (machine, program, inputs);
+    std::chrono::steady_clock::time_point start;
+    start = std::chrono::steady_clock::now ();
+    runDecoded (machine, specializeBudget);
+    std::chrono::duration<double> elapsed;
+    elapsed = std::chrono::steady_clock::now () - start;
+    seconds = elapsed.count ();
+    return machine;
+}